@@ -0,0 +1,129 @@
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "lib/chess_board.h"
+#include "lib/fen.h"
+#include "lib/move_generator.h"
+#include "lib/move_rules.h"
+
+namespace {
+    // Kiwipete: every piece type has moves, captures, pins and castling.
+    constexpr const char* MiddlegameFen = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+
+    NChess::TBoard MakeBoard(const char* fen) {
+        NChess::TBoard board;
+        NChess::LoadFen(board, fen);
+        return board;
+    }
+
+    void BM_GetPieceBySquare(benchmark::State& state) {
+        const NChess::TBoard board = MakeBoard(MiddlegameFen);
+        for (auto _ : state) {
+            for (NChess::TSquare square = 0; square < NChess::SquaresNumber; ++square) {
+                benchmark::DoNotOptimize(board.GetPiece(square));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * NChess::SquaresNumber);
+    }
+    BENCHMARK(BM_GetPieceBySquare);
+
+    void BM_GetPieceByCell(benchmark::State& state) {
+        const NChess::TBoard board = MakeBoard(MiddlegameFen);
+        for (auto _ : state) {
+            for (NChess::TSquare square = 0; square < NChess::SquaresNumber; ++square) {
+                benchmark::DoNotOptimize(board.GetPiece(NChess::ToCell(square)));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * NChess::SquaresNumber);
+    }
+    BENCHMARK(BM_GetPieceByCell);
+
+    // Every legal move of the position made and taken back once.
+    void BM_MovePieceUndoMove(benchmark::State& state) {
+        NChess::TBoard board = MakeBoard(MiddlegameFen);
+        NChess::TMoveList moves;
+        NChess::GenerateMoves(board, board.GetSideToMove(), moves);
+        for (auto _ : state) {
+            for (const NChess::TMove& move : moves) {
+                board.MovePiece(move);
+                board.UndoMove();
+            }
+            benchmark::DoNotOptimize(board.GetHash());
+        }
+        state.SetItemsProcessed(state.iterations() * moves.Size);
+    }
+    BENCHMARK(BM_MovePieceUndoMove);
+
+    // Every (piece of the given type, square) pair of the side to move.
+    void BM_PieceCanMove(benchmark::State& state) {
+        const NChess::EType type = static_cast<NChess::EType>(state.range(0));
+        const NChess::TBoard board = MakeBoard(MiddlegameFen);
+        const NChess::TBitboard pieces = board.GetPieces(board.GetSideToMove(), type);
+        state.SetLabel(std::string(NChess::TypesMap.at(type).begin(), NChess::TypesMap.at(type).end()));
+        for (auto _ : state) {
+            NChess::TBitboard remaining = pieces;
+            while (remaining) {
+                const NChess::TCell from = NChess::ToCell(NChess::PopLowestSquare(remaining));
+                for (NChess::TSquare to = 0; to < NChess::SquaresNumber; ++to) {
+                    benchmark::DoNotOptimize(NChess::PieceCanMove(from, NChess::ToCell(to), board));
+                }
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * NChess::CountBits(pieces) * NChess::SquaresNumber);
+    }
+    BENCHMARK(BM_PieceCanMove)->DenseRange(static_cast<int>(NChess::EType::PAWN), static_cast<int>(NChess::EType::KING));
+
+    // Every (piece, square) pair of the side to move in one batch call.
+    void BM_PieceCanMoveBatch(benchmark::State& state) {
+        const NChess::TBoard board = MakeBoard(MiddlegameFen);
+        std::vector<NChess::TMoveCandidate> candidates;
+        NChess::TBitboard pieces = board.GetPieces(board.GetSideToMove());
+        while (pieces) {
+            const NChess::TSquare from = NChess::PopLowestSquare(pieces);
+            for (NChess::TSquare to = 0; to < NChess::SquaresNumber; ++to) {
+                candidates.push_back({from, to});
+            }
+        }
+        std::unique_ptr<bool[]> legal(new bool[candidates.size()]);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(NChess::PieceCanMoveBatch(board, candidates.data(), candidates.size(), legal.get()));
+        }
+        state.SetItemsProcessed(state.iterations() * candidates.size());
+    }
+    BENCHMARK(BM_PieceCanMoveBatch);
+
+    void BM_GenerateMoves(benchmark::State& state) {
+        const NChess::TBoard board = MakeBoard(MiddlegameFen);
+        for (auto _ : state) {
+            NChess::TMoveList moves;
+            NChess::GenerateMoves(board, board.GetSideToMove(), moves);
+            benchmark::DoNotOptimize(moves.Size);
+        }
+    }
+    BENCHMARK(BM_GenerateMoves);
+
+    void BM_PrintUnicodeBoard(benchmark::State& state) {
+        const NChess::TBoard board = MakeBoard(MiddlegameFen);
+        std::wostringstream out;
+        for (auto _ : state) {
+            out.str(L"");
+            NChess::PrintUnicodeBoard(board, out);
+            benchmark::DoNotOptimize(out);
+        }
+    }
+    BENCHMARK(BM_PrintUnicodeBoard);
+
+    void BM_ConstructAndLoadStartBoard(benchmark::State& state) {
+        for (auto _ : state) {
+            NChess::TBoard board;
+            NChess::LoadStartBoard(board);
+            benchmark::DoNotOptimize(board.GetHash());
+        }
+    }
+    BENCHMARK(BM_ConstructAndLoadStartBoard);
+}
+
+BENCHMARK_MAIN();
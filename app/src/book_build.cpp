@@ -0,0 +1,65 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "lib/mapped_file.h"
+#include "lib/opening_book.h"
+#include "lib/pgn.h"
+
+int main(int argc, char *argv[]) {
+    int plies = 20;
+    long minCount = 1;
+    const char* pgnPath = nullptr;
+    const char* bookPath = nullptr;
+    bool valid = true;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--plies" && i + 1 < argc) {
+            plies = std::atoi(argv[++i]);
+        } else if (arg == "--min-count" && i + 1 < argc) {
+            minCount = std::atol(argv[++i]);
+        } else if (!pgnPath && arg.rfind("--", 0) != 0) {
+            pgnPath = argv[i];
+        } else if (!bookPath && arg.rfind("--", 0) != 0) {
+            bookPath = argv[i];
+        } else {
+            valid = false;
+        }
+    }
+    if (!valid || !pgnPath || !bookPath || plies < 1 || minCount < 1) {
+        std::cerr << "usage: book_build [--plies N] [--min-count N] <games.pgn> <book.bin>" << std::endl;
+        return 1;
+    }
+
+    NChess::TMappedFile file;
+    if (!file.Open(pgnPath, true)) {
+        std::cerr << "cannot map " << pgnPath << std::endl;
+        return 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    NChess::TBookBuilder builder;
+    const NChess::TPgnStats stats = NChess::ReplayPgn(file.GetData(), [&builder, plies](const NChess::TBoard& board, NChess::TMove move) {
+        if (board.GetHistoryLength() < plies) {
+            builder.Add(board, move);
+        }
+    });
+    std::size_t entries = 0;
+    if (!builder.Write(bookPath, static_cast<std::uint32_t>(minCount), entries)) {
+        std::cerr << "cannot write " << bookPath << std::endl;
+        return 1;
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "games " << stats.Games
+              << " moves " << stats.Moves
+              << " illegal_moves " << stats.IllegalMoves
+              << " errors " << stats.Errors << '\n'
+              << "positions_added " << builder.GetRecordsNumber()
+              << " entries " << entries
+              << " time " << static_cast<std::int64_t>(elapsed.count() * 1000) << " ms"
+              << '\n';
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "lib/chess_board.h"
+#include "lib/fen.h"
+
+namespace {
+    const std::vector<std::string_view> DefaultPositions {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+        "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+        "8/8/4k3/8/2p5/8/B2P4/4K3 b - - 12 57",
+    };
+}
+
+// Usage: fen_bench [iterations] [file with one FEN per line]
+int main(int argc, char *argv[]) {
+    int iterations = 200000;
+    if (argc > 1) {
+        iterations = std::atoi(argv[1]);
+    }
+    if (iterations < 1) {
+        std::cerr << "usage: fen_bench [iterations] [fen_file]" << std::endl;
+        return 1;
+    }
+
+    std::string contents;
+    std::vector<std::string_view> positions = DefaultPositions;
+    if (argc > 2) {
+        std::ifstream input(argv[2], std::ios::binary);
+        if (!input) {
+            std::cerr << "cannot open " << argv[2] << std::endl;
+            return 1;
+        }
+        std::ostringstream buffer;
+        buffer << input.rdbuf();
+        contents = buffer.str();
+        positions.clear();
+        std::string_view rest = contents;
+        while (!rest.empty()) {
+            const std::size_t end = rest.find('\n');
+            std::string_view line = rest.substr(0, end);
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            if (!line.empty()) {
+                positions.push_back(line);
+            }
+            rest = end == std::string_view::npos ? std::string_view() : rest.substr(end + 1);
+        }
+    }
+
+    NChess::TBoard board;
+    std::uint64_t invalid = 0;
+    for (std::string_view fen : positions) {
+        if (!NChess::LoadFen(board, fen)) {
+            ++invalid;
+        }
+    }
+
+    std::uint64_t parsed = 0;
+    std::uint64_t checksum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        for (std::string_view fen : positions) {
+            NChess::LoadFen(board, fen);
+            checksum += board.GetHash();
+            ++parsed;
+        }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::uint64_t mismatches = 0;
+    for (std::string_view fen : positions) {
+        if (NChess::LoadFen(board, fen) && NChess::ToFen(board) != fen) {
+            ++mismatches;
+        }
+    }
+
+    std::cout << "positions " << positions.size()
+              << " invalid " << invalid
+              << " roundtrip_mismatches " << mismatches << '\n'
+              << "parsed " << parsed
+              << " time " << static_cast<std::int64_t>(elapsed.count() * 1000) << " ms"
+              << " fens_per_second " << static_cast<std::int64_t>(parsed / elapsed.count())
+              << " checksum " << std::hex << checksum << std::dec << '\n';
+    return 0;
+}
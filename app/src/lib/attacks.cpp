@@ -0,0 +1,159 @@
+#include "attacks.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace NChess {
+
+    namespace NAttacks {
+        std::array<TMagic, SquaresNumber> RookMagics;
+        std::array<TMagic, SquaresNumber> BishopMagics;
+        std::array<TSquareTable, SquaresNumber> BetweenTable;
+        std::array<TSquareTable, SquaresNumber> LineTable;
+
+        namespace {
+            using TDirections = std::array<std::pair<int, int>, 4>;
+
+            constexpr TDirections RookDirections {{{0, 1}, {1, 0}, {0, -1}, {-1, 0}}};
+            constexpr TDirections BishopDirections {{{1, 1}, {1, -1}, {-1, -1}, {-1, 1}}};
+
+            constexpr int RookTableSize = 0x19000;
+            constexpr int BishopTableSize = 0x1480;
+
+            std::array<TBitboard, RookTableSize> RookTable;
+            std::array<TBitboard, BishopTableSize> BishopTable;
+
+            TBitboard SlowSlidingAttacks(TSquare square, TBitboard occupied, const TDirections& directions) {
+                TBitboard attacks = 0;
+                for (auto& [fileStep, rankStep] : directions) {
+                    int file = square % 8 + fileStep;
+                    int rank = square / 8 + rankStep;
+                    while (file >= 0 && file <= 7 && rank >= 0 && rank <= 7) {
+                        const TBitboard bit = SquareBit(rank * 8 + file);
+                        attacks |= bit;
+                        if (occupied & bit) {
+                            break;
+                        }
+                        file += fileStep;
+                        rank += rankStep;
+                    }
+                }
+                return attacks;
+            }
+
+            // Board edges do not influence the attack set unless the slider stands on them.
+            TBitboard RelevantMask(TSquare square, const TDirections& directions) {
+                constexpr TBitboard Rank1 = 0xFFULL;
+                constexpr TBitboard Rank8 = Rank1 << 56;
+                constexpr TBitboard FileA = 0x0101010101010101ULL;
+                constexpr TBitboard FileH = FileA << 7;
+                const TBitboard rankEdges = (Rank1 | Rank8) & ~(Rank1 << (8 * (square / 8)));
+                const TBitboard fileEdges = (FileA | FileH) & ~(FileA << (square % 8));
+                return SlowSlidingAttacks(square, 0, directions) & ~(rankEdges | fileEdges);
+            }
+
+            class TRandom {
+                private:
+                    std::uint64_t State;
+                public:
+                    explicit TRandom(std::uint64_t seed)
+                        : State(seed)
+                    {
+                    }
+                    std::uint64_t Next() {
+                        State ^= State >> 12;
+                        State ^= State << 25;
+                        State ^= State >> 27;
+                        return State * 2685821657736338717ULL;
+                    }
+                    std::uint64_t Sparse() {
+                        return Next() & Next() & Next();
+                    }
+            };
+
+            void InitMagics(std::array<TMagic, SquaresNumber>& magics, TBitboard* table, const TDirections& directions) {
+                std::vector<TBitboard> occupancies;
+                std::vector<TBitboard> references;
+#if !defined(__BMI2__)
+                std::vector<int> epoch(4096, 0);
+                int attempt = 0;
+                TRandom random(0x9E3779B97F4A7C15ULL);
+#endif
+                TBitboard* slice = table;
+
+                for (TSquare square = 0; square < SquaresNumber; ++square) {
+                    TMagic& magic = magics[square];
+                    magic.Mask = RelevantMask(square, directions);
+                    magic.Shift = 64 - CountBits(magic.Mask);
+                    magic.Attacks = slice;
+
+                    occupancies.clear();
+                    references.clear();
+                    TBitboard subset = 0;
+                    do {
+                        occupancies.push_back(subset);
+                        references.push_back(SlowSlidingAttacks(square, subset, directions));
+                        subset = (subset - magic.Mask) & magic.Mask;
+                    } while (subset);
+                    const int size = static_cast<int>(occupancies.size());
+
+#if defined(__BMI2__)
+                    for (int i = 0; i < size; ++i) {
+                        slice[magic.Index(occupancies[i])] = references[i];
+                    }
+#else
+                    bool found = false;
+                    while (!found) {
+                        do {
+                            magic.Magic = random.Sparse();
+                        } while (CountBits((magic.Magic * magic.Mask) >> 56) < 6);
+
+                        ++attempt;
+                        found = true;
+                        for (int i = 0; i < size; ++i) {
+                            const unsigned index = magic.Index(occupancies[i]);
+                            if (epoch[index] < attempt) {
+                                epoch[index] = attempt;
+                                slice[index] = references[i];
+                            } else if (slice[index] != references[i]) {
+                                found = false;
+                                break;
+                            }
+                        }
+                    }
+#endif
+                    slice += size;
+                }
+            }
+
+            void InitLines() {
+                for (TSquare from = 0; from < SquaresNumber; ++from) {
+                    for (TSquare to = 0; to < SquaresNumber; ++to) {
+                        if (from == to) {
+                            continue;
+                        }
+                        const TBitboard ends = SquareBit(from) | SquareBit(to);
+                        if (RookAttacks(from, 0) & SquareBit(to)) {
+                            BetweenTable[from][to] = RookAttacks(from, SquareBit(to)) & RookAttacks(to, SquareBit(from));
+                            LineTable[from][to] = (RookAttacks(from, 0) & RookAttacks(to, 0)) | ends;
+                        } else if (BishopAttacks(from, 0) & SquareBit(to)) {
+                            BetweenTable[from][to] = BishopAttacks(from, SquareBit(to)) & BishopAttacks(to, SquareBit(from));
+                            LineTable[from][to] = (BishopAttacks(from, 0) & BishopAttacks(to, 0)) | ends;
+                        }
+                    }
+                }
+            }
+
+            struct TMagicsInitializer {
+                TMagicsInitializer() {
+                    InitMagics(RookMagics, RookTable.data(), RookDirections);
+                    InitMagics(BishopMagics, BishopTable.data(), BishopDirections);
+                    InitLines();
+                }
+            };
+
+            const TMagicsInitializer MagicsInitializer;
+        }
+    }
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+
+#include "chess_board.h"
+#include "chess_piece.h"
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+namespace NChess {
+
+    namespace NAttacks {
+        using TSquareTable = std::array<TBitboard, SquaresNumber>;
+
+        constexpr TBitboard Step(TSquare square, int fileStep, int rankStep) {
+            const int file = square % 8 + fileStep;
+            const int rank = square / 8 + rankStep;
+            if (file < 0 || file > 7 || rank < 0 || rank > 7) {
+                return 0;
+            }
+            return SquareBit(rank * 8 + file);
+        }
+
+        constexpr TSquareTable MakeKnightTable() {
+            TSquareTable table{};
+            for (TSquare square = 0; square < SquaresNumber; ++square) {
+                table[square] = Step(square, 1, 2) | Step(square, 2, 1) | Step(square, 2, -1) | Step(square, 1, -2)
+                    | Step(square, -1, -2) | Step(square, -2, -1) | Step(square, -2, 1) | Step(square, -1, 2);
+            }
+            return table;
+        }
+
+        constexpr TSquareTable MakeKingTable() {
+            TSquareTable table{};
+            for (TSquare square = 0; square < SquaresNumber; ++square) {
+                table[square] = Step(square, 0, 1) | Step(square, 1, 1) | Step(square, 1, 0) | Step(square, 1, -1)
+                    | Step(square, 0, -1) | Step(square, -1, -1) | Step(square, -1, 0) | Step(square, -1, 1);
+            }
+            return table;
+        }
+
+        constexpr TSquareTable MakePawnTable(int rankStep) {
+            TSquareTable table{};
+            for (TSquare square = 0; square < SquaresNumber; ++square) {
+                table[square] = Step(square, -1, rankStep) | Step(square, 1, rankStep);
+            }
+            return table;
+        }
+
+        inline constexpr TSquareTable KnightTable = MakeKnightTable();
+        inline constexpr TSquareTable KingTable = MakeKingTable();
+        inline constexpr TSquareTable WhitePawnTable = MakePawnTable(1);
+        inline constexpr TSquareTable BlackPawnTable = MakePawnTable(-1);
+
+        // Fancy magic bitboards: every square owns a slice of a shared attack
+        // table addressed by ((occupied & Mask) * Magic) >> Shift, or by
+        // pext(occupied, Mask) when the target supports BMI2.
+        struct TMagic {
+            TBitboard Mask;
+            TBitboard Magic;
+            const TBitboard* Attacks;
+            unsigned Shift;
+
+            unsigned Index(TBitboard occupied) const {
+#if defined(__BMI2__)
+                return static_cast<unsigned>(_pext_u64(occupied, Mask));
+#else
+                return static_cast<unsigned>(((occupied & Mask) * Magic) >> Shift);
+#endif
+            }
+        };
+
+        extern std::array<TMagic, SquaresNumber> RookMagics;
+        extern std::array<TMagic, SquaresNumber> BishopMagics;
+
+        // For two squares on a common rank, file or diagonal: the squares
+        // strictly between them, and the whole line through both. Empty for
+        // unaligned squares.
+        extern std::array<TSquareTable, SquaresNumber> BetweenTable;
+        extern std::array<TSquareTable, SquaresNumber> LineTable;
+    }
+
+    inline TBitboard KnightAttacks(TSquare square) {
+        return NAttacks::KnightTable[square];
+    }
+
+    inline TBitboard KingAttacks(TSquare square) {
+        return NAttacks::KingTable[square];
+    }
+
+    inline TBitboard PawnAttacks(TSquare square, EColor color) {
+        return color == EColor::WHITE ? NAttacks::WhitePawnTable[square] : NAttacks::BlackPawnTable[square];
+    }
+
+    inline TBitboard RookAttacks(TSquare square, TBitboard occupied) {
+        const NAttacks::TMagic& magic = NAttacks::RookMagics[square];
+        return magic.Attacks[magic.Index(occupied)];
+    }
+
+    inline TBitboard BishopAttacks(TSquare square, TBitboard occupied) {
+        const NAttacks::TMagic& magic = NAttacks::BishopMagics[square];
+        return magic.Attacks[magic.Index(occupied)];
+    }
+
+    inline TBitboard QueenAttacks(TSquare square, TBitboard occupied) {
+        return RookAttacks(square, occupied) | BishopAttacks(square, occupied);
+    }
+
+    inline TBitboard BetweenSquares(TSquare from, TSquare to) {
+        return NAttacks::BetweenTable[from][to];
+    }
+
+    inline TBitboard LineThrough(TSquare from, TSquare to) {
+        return NAttacks::LineTable[from][to];
+    }
+}
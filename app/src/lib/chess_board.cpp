@@ -1,105 +1,282 @@
 #include "chess_board.h"
 #include "chess_piece.h"
+#include "evaluation.h"
 #include "move_rules.h"
+#include "stats.h"
 
 #include <iostream>
+#include <type_traits>
 
 namespace NChess {
 
-    TBoard::TBoard()
-        : EmptyPiece(std::make_unique<TChessPiece>(EColor::EMPTY, EType::EMPTY))
-        , CapturedWhite(0)
-        , CapturedBlack(0)
-        , MovesNumber(0)
-    {
-        for (auto &[rank,rankString] : RanksMap) {
-            std::ignore = rankString;
-            for (auto& [file, fileString]:FilesMap) {
-                std::ignore = fileString;
-                base[file][rank] = nullptr;
+    static_assert(std::is_trivially_copyable_v<TPosition>, "positions are cloned with plain copies");
+
+    namespace {
+        // Castling rights that survive a move touching the given square.
+        constexpr std::array<std::uint8_t, SquaresNumber> MakeCastlingMasks() {
+            std::array<std::uint8_t, SquaresNumber> masks{};
+            for (auto& mask : masks) {
+                mask = AllCastling;
             }
+            masks[0] = AllCastling & ~WhiteQueenSide;
+            masks[4] = AllCastling & ~(WhiteKingSide | WhiteQueenSide);
+            masks[7] = AllCastling & ~WhiteKingSide;
+            masks[56] = AllCastling & ~BlackQueenSide;
+            masks[60] = AllCastling & ~(BlackKingSide | BlackQueenSide);
+            masks[63] = AllCastling & ~BlackKingSide;
+            return masks;
+        }
+
+        constexpr std::array<std::uint8_t, SquaresNumber> CastlingMasks = MakeCastlingMasks();
+
+        // Rook squares for a castling king move, chosen by the king's destination.
+        void CastlingRookSquares(TSquare kingTo, TSquare& rookFrom, TSquare& rookTo) {
+            if (kingTo % 8 == 6) {
+                rookFrom = kingTo + 1;
+                rookTo = kingTo - 1;
+            } else {
+                rookFrom = kingTo - 2;
+                rookTo = kingTo + 1;
+            }
+        }
+
+        TSquare CapturedSquare(TMove move) {
+            if (move.GetFlag() != EMoveFlag::EN_PASSANT) {
+                return move.GetTo();
+            }
+            return move.GetFrom() / 8 * 8 + move.GetTo() % 8;
         }
     }
 
-    EColor TBoard::GetColor(TCell cell){
-        if(base[cell.file][cell.rank] == nullptr){
-            return EColor::EMPTY;
-        } else {
-            return base[cell.file][cell.rank]->Color;
+    TPosition::TPosition() {
+        Clear();
+    }
+
+    void TPosition::Clear() {
+        Mailbox.fill(0);
+        ColorBitboards.fill(0);
+        TypeBitboards.fill(0);
+        SideToMove = EColor::WHITE;
+        CastlingRights = 0;
+        EnPassantSquare = NoSquare;
+        HalfmoveClock = 0;
+        Hash = 0;
+        CapturedWhite = 0;
+        CapturedBlack = 0;
+        MovesNumber = 0;
+        MidgameScore = 0;
+        EndgameScore = 0;
+        Phase = 0;
+    }
+
+    void TPosition::PutPiece(TSquare square, const TChessPiece* piece) {
+        RemovePiece(square);
+        if (piece == nullptr || piece->Type == EType::EMPTY) {
+            return;
         }
+        const int index = PieceIndex(piece->Color, piece->Type);
+        Mailbox[square] = static_cast<std::uint8_t>(index);
+        ColorBitboards[static_cast<int>(piece->Color)] |= SquareBit(square);
+        TypeBitboards[static_cast<int>(piece->Type)] |= SquareBit(square);
+        Hash ^= NZobrist::PieceKey(*piece, square);
+        MidgameScore += NEvaluation::MidgameScores[index][square];
+        EndgameScore += NEvaluation::EndgameScores[index][square];
+        Phase += NEvaluation::PhaseWeights[static_cast<int>(piece->Type)];
     }
 
-    bool TBoard::MovePiece(TCell from, TCell to){
-        if(EColor::WHITE == GetColor(to)){
-            ++CapturedWhite;
+    void TPosition::RemovePiece(TSquare square) {
+        const int index = Mailbox[square];
+        const TChessPiece* piece = &PieceTable[index];
+        if (piece->Type == EType::EMPTY) {
+            return;
         }
-        if(EColor::BLACK == GetColor(to)){
+        Mailbox[square] = 0;
+        ColorBitboards[static_cast<int>(piece->Color)] &= ~SquareBit(square);
+        TypeBitboards[static_cast<int>(piece->Type)] &= ~SquareBit(square);
+        Hash ^= NZobrist::PieceKey(*piece, square);
+        MidgameScore -= NEvaluation::MidgameScores[index][square];
+        EndgameScore -= NEvaluation::EndgameScores[index][square];
+        Phase -= NEvaluation::PhaseWeights[static_cast<int>(piece->Type)];
+    }
+
+    // Fills in the captured piece and the special-move flag for a plain from/to pair.
+    TMove TPosition::CreateMove(TSquare from, TSquare to, EType promotion) const {
+        const TChessPiece* piece = GetPiece(from);
+        EMoveFlag flag = EMoveFlag::NONE;
+        int captured = Mailbox[to];
+        if (piece->Type == EType::PAWN) {
+            if (to - from == 16 || from - to == 16) {
+                flag = EMoveFlag::DOUBLE_PUSH;
+            } else if (to == EnPassantSquare && from % 8 != to % 8) {
+                flag = EMoveFlag::EN_PASSANT;
+                captured = PieceIndex(Opponent(piece->Color), EType::PAWN);
+            }
+        } else if (piece->Type == EType::KING && (to - from == 2 || from - to == 2)) {
+            flag = EMoveFlag::CASTLING;
+        }
+        return TMove(from, to, captured, promotion, flag);
+    }
+
+    void TPosition::MakeMove(TMove move, TUndo& undo) {
+        CLCHESS_STATS_SCOPE(MOVE_PIECE);
+        const TSquare from = move.GetFrom();
+        const TSquare to = move.GetTo();
+        const TSquare capturedSquare = CapturedSquare(move);
+        const TChessPiece* piece = GetPiece(from);
+        const TChessPiece* captured = GetPiece(capturedSquare);
+
+        undo.Move = TMove(from, to, Mailbox[capturedSquare], move.GetPromotion(), move.GetFlag());
+        undo.CastlingRights = CastlingRights;
+        undo.EnPassantSquare = static_cast<std::int8_t>(EnPassantSquare);
+        undo.HalfmoveClock = static_cast<std::uint16_t>(HalfmoveClock);
+        undo.Hash = Hash;
+
+        if (captured->Color == EColor::WHITE) {
+            ++CapturedWhite;
+        } else if (captured->Color == EColor::BLACK) {
             ++CapturedBlack;
         }
+        RemovePiece(capturedSquare);
+        RemovePiece(from);
+        if (move.GetPromotion() != EType::EMPTY) {
+            PutPiece(to, InternPiece(piece->Color, move.GetPromotion()));
+        } else {
+            PutPiece(to, piece);
+        }
+        if (move.GetFlag() == EMoveFlag::CASTLING) {
+            TSquare rookFrom, rookTo;
+            CastlingRookSquares(to, rookFrom, rookTo);
+            PutPiece(rookTo, GetPiece(rookFrom));
+            RemovePiece(rookFrom);
+        }
+
+        SetEnPassantSquare(move.GetFlag() == EMoveFlag::DOUBLE_PUSH ? (from + to) / 2 : NoSquare);
+        SetCastlingRights(CastlingRights & CastlingMasks[from] & CastlingMasks[to]);
+        if (piece->Type == EType::PAWN || captured->Type != EType::EMPTY) {
+            HalfmoveClock = 0;
+        } else {
+            ++HalfmoveClock;
+        }
         ++MovesNumber;
-        MoveHistory.push_back({from, to, base[to.file][to.rank]});
-        base[to.file][to.rank] = base[from.file][from.rank];
-        base[from.file][from.rank] = nullptr;
-        return true;
+        SetSideToMove(Opponent(SideToMove));
     }
 
-    bool TBoard::UndoMove(){
-        if(MoveHistory.empty()) {
-            return false;
+    void TPosition::UnmakeMove(const TUndo& undo) {
+        CLCHESS_STATS_SCOPE(UNDO_MOVE);
+        const TMove move = undo.Move;
+        const TSquare from = move.GetFrom();
+        const TSquare to = move.GetTo();
+        const TChessPiece* piece = GetPiece(to);
+
+        if (move.GetFlag() == EMoveFlag::CASTLING) {
+            TSquare rookFrom, rookTo;
+            CastlingRookSquares(to, rookFrom, rookTo);
+            PutPiece(rookFrom, GetPiece(rookTo));
+            RemovePiece(rookTo);
         }
-        auto LastMove = MoveHistory.back();
-        MoveHistory.pop_back();        
-        base[LastMove.from.file][LastMove.from.rank] = base[LastMove.to.file][LastMove.to.rank];
-        base[LastMove.to.file][LastMove.to.rank] = LastMove.CapturedPiece;
-        if(EColor::WHITE == GetColor(LastMove.to)){
-            --CapturedWhite;
+        RemovePiece(to);
+        if (move.GetPromotion() != EType::EMPTY) {
+            PutPiece(from, InternPiece(piece->Color, EType::PAWN));
+        } else {
+            PutPiece(from, piece);
         }
-        if(EColor::BLACK == GetColor(LastMove.to)){
+        const TChessPiece* captured = move.GetCaptured();
+        if (captured->Color == EColor::WHITE) {
+            --CapturedWhite;
+        } else if (captured->Color == EColor::BLACK) {
             --CapturedBlack;
         }
+        PutPiece(CapturedSquare(move), captured);
+
+        CastlingRights = undo.CastlingRights;
+        EnPassantSquare = undo.EnPassantSquare;
+        HalfmoveClock = undo.HalfmoveClock;
+        SideToMove = Opponent(SideToMove);
+        Hash = undo.Hash;
         --MovesNumber;
+    }
+
+    void TBoard::Clear() {
+        TPosition::Clear();
+        History.clear();
+    }
+
+    void TBoard::MovePiece(TMove move) {
+        History.emplace_back();
+        MakeMove(move, History.back());
+    }
+
+    // Coordinate input cannot name a promotion piece, so pawns promote to a queen.
+    void TBoard::MovePiece(TCell from, TCell to){
+        const bool promotes = GetPiece(from)->Type == EType::PAWN && (to.rank == ERank::R1 || to.rank == ERank::R8);
+        MovePiece(CreateMove(ToSquare(from), ToSquare(to), promotes ? EType::QUEEN : EType::EMPTY));
+    }
+
+    bool TBoard::UndoMove(){
+        if(History.empty()) {
+            return false;
+        }
+        UnmakeMove(History.back());
+        History.pop_back();
         return true;
     }
 
-    TChessPiece* TBoard::MakePiece(EColor color, EType type) {
-        Pieces.emplace_back(std::make_unique<TChessPiece>(color, type));
-        return Pieces.back().get();
+    void TPosition::SetSideToMove(EColor color) {
+        if (color != SideToMove) {
+            Hash ^= NZobrist::BlackToMoveKey;
+            SideToMove = color;
+        }
     }
 
-    const TChessPiece* TBoard::GetPiece(EFile file, ERank rank) const {
-        if (base.at(file).at(rank) == nullptr) {
-            return EmptyPiece.get();
-        } else {
-            return base.at(file).at(rank);
+    void TPosition::SetCastlingRights(std::uint8_t rights) {
+        Hash ^= NZobrist::CastlingKeys[CastlingRights] ^ NZobrist::CastlingKeys[rights];
+        CastlingRights = rights;
+    }
+
+    void TPosition::SetEnPassantSquare(TSquare square) {
+        if (EnPassantSquare != NoSquare) {
+            Hash ^= NZobrist::EnPassantKeys[EnPassantSquare % 8];
+        }
+        if (square != NoSquare) {
+            Hash ^= NZobrist::EnPassantKeys[square % 8];
         }
+        EnPassantSquare = square;
+    }
+
+    const TChessPiece* TPosition::MakePiece(EColor color, EType type) {
+        return InternPiece(color, type);
+    }
+
+    const TChessPiece* TPosition::GetPiece(EFile file, ERank rank) const {
+        return GetPiece(ToSquare(file, rank));
     }
 
-    const TChessPiece* TBoard::GetPiece(TCell cell) const {
-        return GetPiece(cell.file, cell.rank);
+    const TChessPiece* TPosition::GetPiece(TCell cell) const {
+        return GetPiece(ToSquare(cell));
     }
 
-    void TBoard::SetPiece(EFile file, ERank rank, TChessPiece* piece) {
-        base[file][rank] = piece;
+    void TPosition::SetPiece(EFile file, ERank rank, const TChessPiece* piece) {
+        PutPiece(ToSquare(file, rank), piece);
     }
 
-    void TBoard::MakeAndSetPiece(EFile file, ERank rank, EColor color, EType type) {
-        TChessPiece* piece = MakePiece(color, type);
+    void TPosition::MakeAndSetPiece(EFile file, ERank rank, EColor color, EType type) {
+        const TChessPiece* piece = MakePiece(color, type);
         SetPiece(file, rank, piece);
     }
 
-    int TBoard::GetCapturedWhite() {
+    int TPosition::GetCapturedWhite() const {
         return CapturedWhite;
     }
 
-    int TBoard::GetCapturedBlack() {
+    int TPosition::GetCapturedBlack() const {
         return CapturedBlack;
     }
 
-    int TBoard::GetMovesNumber(){
+    int TPosition::GetMovesNumber() const {
         return MovesNumber;
     }
 
-    void PrintBoard(const TBoard& board) {
+    void PrintBoard(const TPosition& board) {
         for (auto& [file, fileString]:FilesMap) {
             std::ignore = file;
             std::wcout << fileString << " ";
@@ -117,32 +294,25 @@ namespace NChess {
     }
     
 
-    void PrintUnicodeBoard(const TBoard& board) {
-        auto printFiles = []() {
-            std::wcout << "    |";
-            for (auto& [file, fileString]:FilesMap) {
-                std::ignore = file;
-                std::wcout << fileString << "|";
-            }            
-            std::wcout << std::endl;    
-        };
-            
-        printFiles();
-        for (auto &[rank,rankString] : RanksMap) {
-            std::wcout << rankString << ": |";
-            for (auto& [file, fileString]:FilesMap) {
-                std::ignore = fileString;
-                auto piece = board.GetPiece(file, rank);
-                if (piece->Color == EColor::WHITE) {
-                    std::wcout << UnicodeWhiteTypeMap.at(piece->Type);
-                } else {
-                    std::wcout << UnicodeBlackTypeMap.at(piece->Type);
-                }
-                std::wcout << "|";              
+    void PrintUnicodeBoard(const TPosition& board) {
+        PrintUnicodeBoard(board, std::wcout);
+        std::wcout.flush();
+    }
+
+    void PrintUnicodeBoard(const TPosition& board, std::wostream& out) {
+        CLCHESS_STATS_SCOPE(RENDER);
+        static constexpr wchar_t FilesLine[] = L"    |A|B|C|D|E|F|G|H|\n";
+        out << FilesLine;
+        for (int rank = 0; rank < 8; ++rank) {
+            wchar_t line[] = L"R1: |?|?|?|?|?|?|?|?|\n";
+            line[1] = static_cast<wchar_t>(L'1' + rank);
+            for (int file = 0; file < 8; ++file) {
+                const TChessPiece* piece = board.GetPiece(rank * 8 + file);
+                line[5 + 2 * file] = UnicodePieceTable[PieceIndex(piece->Color, piece->Type)];
             }
-            std::wcout << std::endl;
+            out << line;
         }
-        printFiles();
+        out << FilesLine;
     }
 
     void LoadStartBoard(TBoard& board) {
@@ -163,10 +333,11 @@ namespace NChess {
         board.MakeAndSetPiece(EFile::A, ERank::R8, EColor::BLACK, EType::ROOK);
         board.MakeAndSetPiece(EFile::B, ERank::R8, EColor::BLACK, EType::KNIGHT);
         board.MakeAndSetPiece(EFile::C, ERank::R8, EColor::BLACK, EType::BISHOP);
-        board.MakeAndSetPiece(EFile::D, ERank::R8, EColor::BLACK, EType::KING);
-        board.MakeAndSetPiece(EFile::E, ERank::R8, EColor::BLACK, EType::QUEEN);
+        board.MakeAndSetPiece(EFile::D, ERank::R8, EColor::BLACK, EType::QUEEN);
+        board.MakeAndSetPiece(EFile::E, ERank::R8, EColor::BLACK, EType::KING);
         board.MakeAndSetPiece(EFile::F, ERank::R8, EColor::BLACK, EType::BISHOP);
         board.MakeAndSetPiece(EFile::G, ERank::R8, EColor::BLACK, EType::KNIGHT);
         board.MakeAndSetPiece(EFile::H, ERank::R8, EColor::BLACK, EType::ROOK);
+        board.SetCastlingRights(AllCastling);
     }  
 }
\ No newline at end of file
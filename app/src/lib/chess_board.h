@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <iosfwd>
 #include <map>
 #include <vector>
 #include <memory>
@@ -7,6 +10,7 @@
 #include <vector>
 
 #include "chess_piece.h"
+#include "zobrist.h"
 
 namespace NChess {
     enum class ERank {
@@ -33,28 +37,6 @@ namespace NChess {
         {'7', ERank::R7},
         {'8', ERank::R8}        
     };
-
-    const std::map<ERank, ERank> NextRankMap {
-        {ERank::R1, ERank::R2},
-        {ERank::R2, ERank::R3},
-        {ERank::R3, ERank::R4},
-        {ERank::R4, ERank::R5},
-        {ERank::R5, ERank::R6},
-        {ERank::R6, ERank::R7},
-        {ERank::R7, ERank::R8},
-        {ERank::R8, ERank::END}
-    };
-
-    const std::map<ERank, ERank> PrevRankMap {
-        {ERank::R1, ERank::BEGIN},
-        {ERank::R2, ERank::R1},
-        {ERank::R3, ERank::R2},
-        {ERank::R4, ERank::R3},
-        {ERank::R5, ERank::R4},
-        {ERank::R6, ERank::R5},
-        {ERank::R7, ERank::R6},
-        {ERank::R8, ERank::R7}
-    };    
     
     enum class EFile {
         BEGIN, A, B, C, D, E, F, G, H, END
@@ -80,75 +62,249 @@ namespace NChess {
         {'g', EFile::G},
         {'h', EFile::H}
     };
-
-    const std::map<EFile, EFile> NextFileMap {
-        {EFile::A, EFile::B},
-        {EFile::B, EFile::C},
-        {EFile::C, EFile::D},
-        {EFile::D, EFile::E},
-        {EFile::E, EFile::F},
-        {EFile::F, EFile::G},
-        {EFile::G, EFile::H},
-        {EFile::H, EFile::END}
-    };
-
-    const std::map<EFile, EFile> PrevFileMap {     
-        {EFile::A, EFile::BEGIN},   
-        {EFile::B, EFile::A},
-        {EFile::C, EFile::B},
-        {EFile::D, EFile::C},
-        {EFile::E, EFile::D},
-        {EFile::F, EFile::E},
-        {EFile::G, EFile::F},
-        {EFile::H, EFile::G}
-    };
     
     struct TCell {
         EFile file;
         ERank rank;
-        bool operator ==(TCell cell) {
+        bool operator ==(TCell cell) const {
             return cell.file == file && cell.rank == rank;
         }
 
-        bool operator !=(TCell cell) {
+        bool operator !=(TCell cell) const {
             return !(cell.file == file && cell.rank == rank);
         }
     };
 
-    struct TMove {
-        TCell from;
-        TCell to;
-        TChessPiece* CapturedPiece;
+    // Squares are numbered a1 = 0, b1 = 1, ..., h8 = 63.
+    using TSquare = int;
+    using TBitboard = std::uint64_t;
+
+    constexpr int SquaresNumber = 64;
+
+    constexpr TSquare ToSquare(EFile file, ERank rank) {
+        return (static_cast<int>(rank) - 1) * 8 + (static_cast<int>(file) - 1);
+    }
+
+    constexpr TSquare ToSquare(TCell cell) {
+        return ToSquare(cell.file, cell.rank);
+    }
+
+    constexpr TCell ToCell(TSquare square) {
+        return {static_cast<EFile>(square % 8 + 1), static_cast<ERank>(square / 8 + 1)};
+    }
+
+    constexpr TBitboard SquareBit(TSquare square) {
+        return TBitboard(1) << square;
+    }
+
+    inline TSquare LowestSquare(TBitboard bitboard) {
+        return __builtin_ctzll(bitboard);
+    }
+
+    inline TSquare PopLowestSquare(TBitboard& bitboard) {
+        const TSquare square = LowestSquare(bitboard);
+        bitboard &= bitboard - 1;
+        return square;
+    }
+
+    inline int CountBits(TBitboard bitboard) {
+        return __builtin_popcountll(bitboard);
+    }
+
+    constexpr TSquare NoSquare = -1;
+
+    enum class EMoveFlag : std::uint8_t {
+        NONE,
+        DOUBLE_PUSH,
+        EN_PASSANT,
+        CASTLING
+    };
+
+    // Packed move: from:6 | to:6 | promotion:3 | captured:4 | flag:2. The
+    // captured piece is an index into PieceTable, zero for quiet moves.
+    class TMove {
+        private:
+            std::uint32_t Data;
+            static constexpr int ToShift = 6;
+            static constexpr int PromotionShift = 12;
+            static constexpr int CapturedShift = 15;
+            static constexpr int FlagShift = 19;
+        public:
+            constexpr TMove()
+                : Data(0)
+            {
+            }
+            constexpr TMove(TSquare from, TSquare to, int capturedIndex = 0,
+                    EType promotion = EType::EMPTY, EMoveFlag flag = EMoveFlag::NONE)
+                : Data(static_cast<std::uint32_t>(from)
+                    | static_cast<std::uint32_t>(to) << ToShift
+                    | static_cast<std::uint32_t>(promotion) << PromotionShift
+                    | static_cast<std::uint32_t>(capturedIndex) << CapturedShift
+                    | static_cast<std::uint32_t>(flag) << FlagShift)
+            {
+            }
+            constexpr TSquare GetFrom() const {
+                return Data & 63;
+            }
+            constexpr TSquare GetTo() const {
+                return (Data >> ToShift) & 63;
+            }
+            constexpr EType GetPromotion() const {
+                return static_cast<EType>((Data >> PromotionShift) & 7);
+            }
+            constexpr int GetCapturedIndex() const {
+                return (Data >> CapturedShift) & 15;
+            }
+            constexpr const TChessPiece* GetCaptured() const {
+                return &PieceTable[GetCapturedIndex()];
+            }
+            constexpr EMoveFlag GetFlag() const {
+                return static_cast<EMoveFlag>((Data >> FlagShift) & 3);
+            }
+            constexpr bool IsCapture() const {
+                return GetCapturedIndex() != 0;
+            }
+            // From, to and promotion: enough to identify a move within a position.
+            constexpr std::uint16_t Compact() const {
+                return static_cast<std::uint16_t>(Data & 0x7FFF);
+            }
+            constexpr bool IsNull() const {
+                return Data == 0;
+            }
+            constexpr bool operator ==(TMove move) const {
+                return Data == move.Data;
+            }
+            constexpr bool operator !=(TMove move) const {
+                return Data != move.Data;
+            }
+    };
+
+    constexpr std::uint8_t WhiteKingSide = 1;
+    constexpr std::uint8_t WhiteQueenSide = 2;
+    constexpr std::uint8_t BlackKingSide = 4;
+    constexpr std::uint8_t BlackQueenSide = 8;
+    constexpr std::uint8_t AllCastling = 15;
+
+    // Everything MovePiece needs to restore the position on UndoMove.
+    struct TUndo {
+        TMove Move;
+        std::uint8_t CastlingRights;
+        std::int8_t EnPassantSquare;
+        std::uint16_t HalfmoveClock;
+        THash Hash;
     };
 
-    class TBoard {    
+    // Pieces and game state, without the moves that led to them. Small and
+    // trivially copyable: searches, scratch boards and the move rules work on
+    // positions, and MakeMove hands the undo record to the caller.
+    class TPosition {
         private:
-            EColor GetColor(TCell cell);
-            using TBaseBoard=std::unordered_map<EFile, std::unordered_map<ERank, TChessPiece*>>;
-            TBaseBoard base;
-            std::unique_ptr<TChessPiece> EmptyPiece;
-            std::vector<std::unique_ptr<TChessPiece>> Pieces;
-            std::vector<TMove> MoveHistory;
+            void PutPiece(TSquare square, const TChessPiece* piece);
+            void RemovePiece(TSquare square);
+            std::array<std::uint8_t, SquaresNumber> Mailbox;
+            std::array<TBitboard, 3> ColorBitboards;
+            std::array<TBitboard, 7> TypeBitboards;
+            EColor SideToMove;
+            std::uint8_t CastlingRights;
+            TSquare EnPassantSquare;
+            int HalfmoveClock;
+            THash Hash;
             int CapturedWhite;
             int CapturedBlack;
             int MovesNumber;
+            int MidgameScore;
+            int EndgameScore;
+            int Phase;
         public:
-            TBoard();            
+            TPosition();
+            void Clear();
             const TChessPiece* GetPiece(EFile file, ERank rank) const;
             const TChessPiece* GetPiece(TCell cell) const;
-            TChessPiece* MakePiece(EColor color, EType type);
-            void SetPiece(EFile file, ERank rank, TChessPiece* piece);
+            const TChessPiece* GetPiece(TSquare square) const {
+                return &PieceTable[Mailbox[square]];
+            }
+            TBitboard GetPieces(EColor color) const {
+                return ColorBitboards[static_cast<int>(color)];
+            }
+            TBitboard GetPieces(EColor color, EType type) const {
+                return ColorBitboards[static_cast<int>(color)] & TypeBitboards[static_cast<int>(type)];
+            }
+            TBitboard GetOccupied() const {
+                return ColorBitboards[static_cast<int>(EColor::WHITE)] | ColorBitboards[static_cast<int>(EColor::BLACK)];
+            }
+            const TChessPiece* MakePiece(EColor color, EType type);
+            void SetPiece(EFile file, ERank rank, const TChessPiece* piece);
+            void SetPiece(TSquare square, const TChessPiece* piece) {
+                PutPiece(square, piece);
+            }
             void MakeAndSetPiece(EFile file, ERank rank, EColor color, EType type);
-            bool MovePiece(TCell from, TCell to);
+            TMove CreateMove(TSquare from, TSquare to, EType promotion = EType::EMPTY) const;
+            // Plays 'move' and fills 'undo' for the UnmakeMove that takes it back.
+            void MakeMove(TMove move, TUndo& undo);
+            void UnmakeMove(const TUndo& undo);
+            int GetCapturedWhite() const;
+            int GetCapturedBlack() const;
+            int GetMovesNumber() const;
+            void SetMovesNumber(int movesNumber) {
+                MovesNumber = movesNumber;
+            }
+            EColor GetSideToMove() const {
+                return SideToMove;
+            }
+            void SetSideToMove(EColor color);
+            std::uint8_t GetCastlingRights() const {
+                return CastlingRights;
+            }
+            void SetCastlingRights(std::uint8_t rights);
+            TSquare GetEnPassantSquare() const {
+                return EnPassantSquare;
+            }
+            void SetEnPassantSquare(TSquare square);
+            int GetHalfmoveClock() const {
+                return HalfmoveClock;
+            }
+            void SetHalfmoveClock(int clock) {
+                HalfmoveClock = clock;
+            }
+            THash GetHash() const {
+                return Hash;
+            }
+            // Evaluation terms from White's point of view, updated with every
+            // piece placed or removed (see evaluation.h).
+            int GetMidgameScore() const {
+                return MidgameScore;
+            }
+            int GetEndgameScore() const {
+                return EndgameScore;
+            }
+            int GetPhase() const {
+                return Phase;
+            }
+    };
+
+    // A position with the undo history of the game played on it. The history
+    // grows with the game, so games have no length limit.
+    class TBoard : public TPosition {
+        private:
+            std::vector<TUndo> History;
+        public:
+            void Clear();
+            void MovePiece(TMove move);
+            void MovePiece(TCell from, TCell to);
             bool UndoMove();
-            int GetCapturedWhite();
-            int GetCapturedBlack();
-            int GetMovesNumber();
+            int GetHistoryLength() const {
+                return static_cast<int>(History.size());
+            }
+            const TUndo& GetHistory(int index) const {
+                return History[index];
+            }
     };
 
-    void PrintBoard(const TBoard& board);
+    void PrintBoard(const TPosition& board);
+
+    void PrintUnicodeBoard(const TPosition& board);
 
-    void PrintUnicodeBoard(const TBoard& board);
+    void PrintUnicodeBoard(const TPosition& board, std::wostream& out);
 
     void LoadStartBoard(TBoard& board); 
 
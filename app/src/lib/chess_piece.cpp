@@ -2,31 +2,31 @@
 
 namespace NChess {
 
-    std::unique_ptr<TChessPiece> MakeEmpty() {
-        return std::make_unique<TChessPiece>(EColor::EMPTY, EType::EMPTY);
+    const TChessPiece* MakeEmpty() {
+        return InternPiece(EColor::EMPTY, EType::EMPTY);
     }
 
-    std::unique_ptr<TChessPiece> MakePawn(EColor color) {
-        return std::make_unique<TChessPiece>(color, EType::PAWN);
+    const TChessPiece* MakePawn(EColor color) {
+        return InternPiece(color, EType::PAWN);
     }
 
-    std::unique_ptr<TChessPiece> MakeBishop(EColor color) {
-        return std::make_unique<TChessPiece>(color, EType::BISHOP);
+    const TChessPiece* MakeBishop(EColor color) {
+        return InternPiece(color, EType::BISHOP);
     }
 
-    std::unique_ptr<TChessPiece> MakeKnight(EColor color) {
-        return std::make_unique<TChessPiece>(color, EType::KNIGHT);
+    const TChessPiece* MakeKnight(EColor color) {
+        return InternPiece(color, EType::KNIGHT);
     }
 
-    std::unique_ptr<TChessPiece> MakeRook(EColor color) {
-        return std::make_unique<TChessPiece>(color, EType::ROOK);
+    const TChessPiece* MakeRook(EColor color) {
+        return InternPiece(color, EType::ROOK);
     }
-    std::unique_ptr<TChessPiece> MakeQueen(EColor color) {
-        return std::make_unique<TChessPiece>(color, EType::QUEEN);
+    const TChessPiece* MakeQueen(EColor color) {
+        return InternPiece(color, EType::QUEEN);
     }
 
-    std::unique_ptr<TChessPiece> MakeKing(EColor color) {
-        return std::make_unique<TChessPiece>(color, EType::KING);
+    const TChessPiece* MakeKing(EColor color) {
+        return InternPiece(color, EType::KING);
     }
 
 } // namespace NChess
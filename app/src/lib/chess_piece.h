@@ -1,7 +1,7 @@
 #pragma once
+#include <array>
 #include <unordered_map>
 #include <string>
-#include <memory>
 
 namespace NChess {
 
@@ -56,22 +56,64 @@ namespace NChess {
         {EColor::BLACK, L"Black"}
     };
 
+    inline EColor Opponent(EColor color) {
+        return color == EColor::WHITE ? EColor::BLACK : EColor::WHITE;
+    }
+
     struct TChessPiece {        
         const EColor Color;
         const EType Type;
-        TChessPiece(const EColor color, const EType type) 
+        constexpr TChessPiece(const EColor color, const EType type) 
         : Color(color)
         , Type(type)
         {            
         }
     };
 
-    std::unique_ptr<TChessPiece> MakeEmpty();
-    std::unique_ptr<TChessPiece> MakePawn(EColor color);
-    std::unique_ptr<TChessPiece> MakeBishop(EColor color);
-    std::unique_ptr<TChessPiece> MakeKnight(EColor color);
-    std::unique_ptr<TChessPiece> MakeRook(EColor color);
-    std::unique_ptr<TChessPiece> MakeQueen(EColor color);
-    std::unique_ptr<TChessPiece> MakeKing(EColor color);
+    // Pieces are immutable, so every board shares the 13 distinct ones below:
+    // index 0 is the empty square, then white and black pawn..king.
+    constexpr int PiecesNumber = 13;
+
+    inline constexpr std::array<TChessPiece, PiecesNumber> PieceTable {{
+        {EColor::EMPTY, EType::EMPTY},
+        {EColor::WHITE, EType::PAWN},
+        {EColor::WHITE, EType::BISHOP},
+        {EColor::WHITE, EType::KNIGHT},
+        {EColor::WHITE, EType::ROOK},
+        {EColor::WHITE, EType::QUEEN},
+        {EColor::WHITE, EType::KING},
+        {EColor::BLACK, EType::PAWN},
+        {EColor::BLACK, EType::BISHOP},
+        {EColor::BLACK, EType::KNIGHT},
+        {EColor::BLACK, EType::ROOK},
+        {EColor::BLACK, EType::QUEEN},
+        {EColor::BLACK, EType::KING},
+    }};
+
+    // Board glyphs in PieceTable order, for rendering without map lookups.
+    inline constexpr std::array<wchar_t, PiecesNumber> UnicodePieceTable {
+        L' ',
+        L'\u2659', L'\u2657', L'\u2658', L'\u2656', L'\u2655', L'\u2654',
+        L'\u265F', L'\u265D', L'\u265E', L'\u265C', L'\u265B', L'\u265A',
+    };
+
+    constexpr int PieceIndex(EColor color, EType type) {
+        if (color == EColor::EMPTY || type == EType::EMPTY) {
+            return 0;
+        }
+        return (static_cast<int>(color) - 1) * 6 + static_cast<int>(type);
+    }
+
+    constexpr const TChessPiece* InternPiece(EColor color, EType type) {
+        return &PieceTable[PieceIndex(color, type)];
+    }
+
+    const TChessPiece* MakeEmpty();
+    const TChessPiece* MakePawn(EColor color);
+    const TChessPiece* MakeBishop(EColor color);
+    const TChessPiece* MakeKnight(EColor color);
+    const TChessPiece* MakeRook(EColor color);
+    const TChessPiece* MakeQueen(EColor color);
+    const TChessPiece* MakeKing(EColor color);
 
 }
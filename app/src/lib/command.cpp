@@ -1,44 +1,91 @@
 #include "command.h"
 #include "utils.h"
 #include "move_rules.h"
+#include "stats.h"
 
+#include <cstdint>
 #include <iostream>
 
 namespace NChess {
 
-    bool TCommand::ValidateInput(const std::wstring& pos){
-        if (pos.size() != 2) {
-            std::wcout << "invalid argument: " << pos << std::endl;
-            return false;
-        }
-
-        if (pos[0] < 'a' || pos[0] > 'h') {
-            std::wcout << "invalid argument: " << pos << std::endl;
-            return false;
+    namespace {
+        std::wstring CellToString(TCell cell) {
+            std::wstring result;
+            result += static_cast<wchar_t>(L'a' + static_cast<int>(cell.file) - 1);
+            result += static_cast<wchar_t>(L'1' + static_cast<int>(cell.rank) - 1);
+            return result;
         }
+    }
 
-        if (pos[1] < '1' || pos[1] > '8') {
-            std::wcout << "invalid argument: " << pos << std::endl;
+    bool TCommand::ValidateInput(const std::wstring& pos, std::wostream& errors){
+        if (pos.size() != 2 || pos[0] < 'a' || pos[0] > 'h' || pos[1] < '1' || pos[1] > '8') {
+            errors << "invalid argument: " << pos;
             return false;
         }
         return true;
     }
 
     bool TCommand::ValidateNextTurn(TCell from) {
-        return Board.GetPiece(from)->Color == NextTurn;
+        return Board.GetPiece(from)->Color == Board.GetSideToMove();
     }
 
     bool TCommand::ValidateMove(TCell from, TCell to){        
         return PieceCanMove(from, to, Board);                
     }
 
-    void TCommand::UndoMove() {
+    bool TCommand::UndoMove() {
         if(!Board.UndoMove()){
             Info << "No moves to undo";
-        } else {
-            NextTurn = (NextTurn == EColor::WHITE) ? EColor::BLACK : EColor::WHITE;
-            Info << "Move has been undone";
+            return false;
+        }
+        Info << "Move has been undone";
+        return true;
+    }
+
+    bool TCommand::EngineMove() {
+        TMove bookMove;
+        if (Book && Book->ChooseMove(Board, BookRandom(), bookMove)) {
+            Board.MovePiece(bookMove);
+            Info << "Engine played " << CellToString(ToCell(bookMove.GetFrom())) << CellToString(ToCell(bookMove.GetTo())) << " (book)";
+            return true;
+        }
+        const TSearchResult result = ParallelSearch(Board, Table, EngineLimits);
+        if (!result.HasMove) {
+            Info << "Engine has no legal moves";
+            return false;
+        }
+        Board.MovePiece(result.BestMove);
+        Info << "Engine played " << CellToString(ToCell(result.BestMove.GetFrom())) << CellToString(ToCell(result.BestMove.GetTo()))
+             << " (depth " << result.Depth << ", score " << result.Score
+             << ", nodes " << result.Nodes << ", " << result.Time.count() << " ms)";
+        return true;
+    }
+
+    bool TCommand::ShowStats() {
+        const std::string report = NStats::Report();
+        Info << '\n' << std::wstring(report.begin(), report.end());
+        return NStats::Enabled;
+    }
+
+    bool TCommand::ApplyMove(const std::wstring& from, const std::wstring& to) {
+        if (!ValidateInput(from, Info) || !ValidateInput(to, Info)) {
+            return false;
+        }
+        TCell fromCell{CharFilesMap.at(from[0]), CharRanksMap.at(from[1])};
+        TCell toCell{CharFilesMap.at(to[0]), CharRanksMap.at(to[1])};
+        if (!ValidateNextTurn(fromCell)) {
+            const std::wstring& chessColor = NChess::ColorsMap.at(Board.GetSideToMove());
+            Info << "Can not move. It is turn of " << chessColor << " to move";
+            return false;
         }
+        if (!ValidateMove(fromCell, toCell)) {
+            const std::wstring& chessPiece = NChess::TypesMap.at(Board.GetPiece(fromCell)->Type);
+            const std::wstring& chessColor = NChess::ColorsMap.at(Board.GetPiece(fromCell)->Color);
+            Info << "Cannot move " << chessColor << " '" << chessPiece << "' from " << from << " to " << to;            
+            return false;
+        }
+        Board.MovePiece(fromCell, toCell);
+        return true;
     }
 
     void TCommand::ProcessMove() {        
@@ -50,44 +97,78 @@ namespace NChess {
             std::wcin >> from;
             std::wcout << "Enter 'to' position(e2): ";
             std::wcin >> to;
-            valid = ValidateInput(from) && ValidateInput(to);
-        }
-        TCell fromCell{CharFilesMap.at(from[0]), CharRanksMap.at(from[1])};
-        TCell toCell{CharFilesMap.at(to[0]), CharRanksMap.at(to[1])};
-        if (!ValidateNextTurn(fromCell)) {
-            const std::wstring& chessColor = NChess::ColorsMap.at(NextTurn);
-            Info << "Can not move. It is turn of " << chessColor << " to move";
-        } else if (!ValidateMove(fromCell, toCell)) {
-            const std::wstring& chessPiece = NChess::TypesMap.at(Board.GetPiece(fromCell)->Type);
-            const std::wstring& chessColor = NChess::ColorsMap.at(Board.GetPiece(fromCell)->Color);
-            Info << "Cannot move " << chessColor << " '" << chessPiece << "' from " << from << " to " << to;            
-        } else {
-            Board.MovePiece(fromCell, toCell);
-            NextTurn = (NextTurn == EColor::WHITE) ? EColor::BLACK : EColor::WHITE;
+            valid = ValidateInput(from, std::wcout) && ValidateInput(to, std::wcout);
+            if (!valid) {
+                std::wcout << std::endl;
+            }
         }
+        ApplyMove(from, to);
+    }
+
+    void TCommand::Render(std::wostream& out) {
+        NChess::PrintUnicodeBoard(Board, out);
+        out << "score: white: [" << Board.GetCapturedBlack() 
+            << "], black: [" <<  Board.GetCapturedWhite() << "], " 
+            << "moves: [" << Board.GetMovesNumber() << "] \n";
+        out << "status: " << Info.str() << '\n';
     }
 
     void TCommand::Process() {
         std::wstring command;
         while (true) {
+            std::wostringstream frame;
+            Render(frame);
             NUtil::ClearScreen();
-            NChess::PrintUnicodeBoard(Board);
-            std::wcout << "score: white: [" << Board.GetCapturedBlack() 
-                    << "], black: [" <<  Board.GetCapturedWhite() << "], " 
-                    << "moves: [" << Board.GetMovesNumber() << "] "
-                    << std::endl;
-            std::wcout << "status: " << Info.str() << std::endl;
-            std::wcout << "Enter command (move[m], undo[u], quit[q]): ";
+            std::wcout << frame.str() << "Enter command (move[m], undo[u], engine[e], stats[s], quit[q]): " << std::flush;
             std::wcin >> command;
             Info.str(L"");
             if (command == L"q" || command == L"quit") {
                 break;
             } else if (command == L"u" || command == L"undo") {
                 UndoMove();
+            } else if (command == L"e" || command == L"engine") {
+                EngineMove();
+            } else if (command == L"s" || command == L"stats") {
+                ShowStats();
             } else {
-                std::wcout << "Turn of " << NChess::ColorsMap.at(NextTurn) << " to move" << std::endl;
+                std::wcout << "Turn of " << NChess::ColorsMap.at(Board.GetSideToMove()) << " to move" << std::endl;
                 ProcessMove();
             }      
         }
     }
+
+    void TCommand::ProcessScript(std::wistream& input) {
+        std::wstring command;
+        std::uint64_t commands = 0;
+        std::uint64_t rejected = 0;
+        while (input >> command) {
+            if (command == L"q" || command == L"quit") {
+                break;
+            }
+            Info.str(L"");
+            ++commands;
+            bool applied = false;
+            if (command == L"u" || command == L"undo") {
+                applied = UndoMove();
+            } else if (command == L"e" || command == L"engine") {
+                applied = EngineMove();
+            } else if (command == L"s" || command == L"stats") {
+                applied = ShowStats();
+            } else if (command == L"m" || command == L"move") {
+                std::wstring from, to;
+                input >> from >> to;
+                applied = ApplyMove(from, to);
+            } else {
+                Info << "unknown command: " << command;
+            }
+            if (!applied) {
+                ++rejected;
+            }
+        }
+
+        std::wostringstream frame;
+        Render(frame);
+        frame << "script: commands: [" << commands << "], rejected: [" << rejected << "]\n";
+        std::wcout << frame.str() << std::flush;
+    }
 }
@@ -1,26 +1,45 @@
 #pragma once
 
 #include "chess_board.h"
+#include "opening_book.h"
+#include "search.h"
+#include "transposition_table.h"
+#include <random>
 #include <sstream>
 
 namespace NChess {
     class TCommand {
         private:                        
             TBoard& Board;
-            EColor NextTurn;
+            TTranspositionTable& Table;
+            TSearchLimits EngineLimits;
+            const TOpeningBook* Book;
+            std::mt19937_64 BookRandom;
             std::wstringstream Info;
-            bool ValidateInput(const std::wstring& pos);
+            bool ValidateInput(const std::wstring& pos, std::wostream& errors);
             bool ValidateMove(TCell from, TCell to);   
             bool ValidateNextTurn(TCell from);                     
+            bool ApplyMove(const std::wstring& from, const std::wstring& to);
             void ProcessMove();
-            void UndoMove();
+            bool UndoMove();
+            bool EngineMove();
+            bool ShowStats();
+            void Render(std::wostream& out);
         public:
-            TCommand(TBoard& board) 
+            // With a book the engine plays book moves while the position is in it.
+            TCommand(TBoard& board, TTranspositionTable& table, const TSearchLimits& engineLimits, const TOpeningBook* book = nullptr)
                 : Board(board)
-                , NextTurn(EColor::WHITE)
+                , Table(table)
+                , EngineLimits(engineLimits)
+                , Book(book)
+                , BookRandom(std::random_device{}())
             {
                 NChess::LoadStartBoard(Board);
             }
             void Process();
+            // Headless mode: runs every command of the script (same commands
+            // as the interactive prompt) and prints only the final frame in a
+            // single write.
+            void ProcessScript(std::wistream& input);
     };
 }
@@ -0,0 +1,220 @@
+#include "fen.h"
+
+namespace NChess {
+
+    const std::string_view StartFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+    namespace {
+        EType CharToType(char c) {
+            switch (c | 0x20) {
+                case 'p': return EType::PAWN;
+                case 'n': return EType::KNIGHT;
+                case 'b': return EType::BISHOP;
+                case 'r': return EType::ROOK;
+                case 'q': return EType::QUEEN;
+                case 'k': return EType::KING;
+                default: return EType::EMPTY;
+            }
+        }
+
+        char TypeToChar(EType type) {
+            switch (type) {
+                case EType::PAWN: return 'p';
+                case EType::KNIGHT: return 'n';
+                case EType::BISHOP: return 'b';
+                case EType::ROOK: return 'r';
+                case EType::QUEEN: return 'q';
+                case EType::KING: return 'k';
+                default: return ' ';
+            }
+        }
+
+        class TFenReader {
+            private:
+                std::string_view Text;
+                std::size_t Position;
+            public:
+                explicit TFenReader(std::string_view text)
+                    : Text(text)
+                    , Position(0)
+                {
+                }
+                bool AtEnd() const {
+                    return Position >= Text.size();
+                }
+                char Peek() const {
+                    return AtEnd() ? '\0' : Text[Position];
+                }
+                char Next() {
+                    return AtEnd() ? '\0' : Text[Position++];
+                }
+                // Fields are separated by one or more spaces; returns false at the end of input.
+                bool SkipSpaces() {
+                    const std::size_t start = Position;
+                    while (!AtEnd() && Text[Position] == ' ') {
+                        ++Position;
+                    }
+                    return Position > start && !AtEnd();
+                }
+                bool ReadNumber(int& value) {
+                    if (AtEnd() || Peek() < '0' || Peek() > '9') {
+                        return false;
+                    }
+                    value = 0;
+                    while (!AtEnd() && Peek() >= '0' && Peek() <= '9') {
+                        value = value * 10 + (Next() - '0');
+                        if (value > 100000) {
+                            return false;
+                        }
+                    }
+                    return true;
+                }
+        };
+    }
+
+    bool LoadFen(TBoard& board, std::string_view fen) {
+        board.Clear();
+        TFenReader reader(fen);
+
+        int rank = 7;
+        int file = 0;
+        while (true) {
+            const char c = reader.Next();
+            if (c == '/') {
+                if (file != 8 || rank == 0) {
+                    return false;
+                }
+                --rank;
+                file = 0;
+            } else if (c >= '1' && c <= '8') {
+                file += c - '0';
+                if (file > 8) {
+                    return false;
+                }
+            } else if (c == ' ') {
+                break;
+            } else {
+                const EType type = CharToType(c);
+                if (type == EType::EMPTY || file > 7) {
+                    return false;
+                }
+                const EColor color = (c >= 'a') ? EColor::BLACK : EColor::WHITE;
+                board.SetPiece(rank * 8 + file, InternPiece(color, type));
+                ++file;
+            }
+        }
+        if (rank != 0 || file != 8) {
+            return false;
+        }
+
+        reader.SkipSpaces();
+        const char side = reader.Next();
+        if (side == 'b') {
+            board.SetSideToMove(EColor::BLACK);
+        } else if (side != 'w') {
+            return false;
+        }
+        if (!reader.SkipSpaces()) {
+            return false;
+        }
+
+        std::uint8_t rights = 0;
+        if (reader.Peek() == '-') {
+            reader.Next();
+        } else {
+            while (!reader.AtEnd() && reader.Peek() != ' ') {
+                switch (reader.Next()) {
+                    case 'K': rights |= WhiteKingSide; break;
+                    case 'Q': rights |= WhiteQueenSide; break;
+                    case 'k': rights |= BlackKingSide; break;
+                    case 'q': rights |= BlackQueenSide; break;
+                    default: return false;
+                }
+            }
+        }
+        board.SetCastlingRights(rights);
+        if (!reader.SkipSpaces()) {
+            return false;
+        }
+
+        if (reader.Peek() == '-') {
+            reader.Next();
+        } else {
+            const char epFile = reader.Next();
+            const char epRank = reader.Next();
+            if (epFile < 'a' || epFile > 'h' || (epRank != '3' && epRank != '6')) {
+                return false;
+            }
+            board.SetEnPassantSquare((epRank - '1') * 8 + (epFile - 'a'));
+        }
+
+        int halfmoveClock = 0;
+        int fullmoveNumber = 1;
+        if (reader.SkipSpaces()) {
+            if (!reader.ReadNumber(halfmoveClock)) {
+                return false;
+            }
+            if (reader.SkipSpaces() && !reader.ReadNumber(fullmoveNumber)) {
+                return false;
+            }
+        }
+        board.SetHalfmoveClock(halfmoveClock);
+        board.SetMovesNumber(2 * (fullmoveNumber > 0 ? fullmoveNumber - 1 : 0)
+            + (board.GetSideToMove() == EColor::BLACK ? 1 : 0));
+        return true;
+    }
+
+    std::string ToFen(const TPosition& board) {
+        std::string fen;
+        fen.reserve(92);
+        for (int rank = 7; rank >= 0; --rank) {
+            int empty = 0;
+            for (int file = 0; file < 8; ++file) {
+                const TChessPiece* piece = board.GetPiece(rank * 8 + file);
+                if (piece->Type == EType::EMPTY) {
+                    ++empty;
+                    continue;
+                }
+                if (empty > 0) {
+                    fen += static_cast<char>('0' + empty);
+                    empty = 0;
+                }
+                const char c = TypeToChar(piece->Type);
+                fen += piece->Color == EColor::WHITE ? static_cast<char>(c - 'a' + 'A') : c;
+            }
+            if (empty > 0) {
+                fen += static_cast<char>('0' + empty);
+            }
+            if (rank > 0) {
+                fen += '/';
+            }
+        }
+
+        fen += board.GetSideToMove() == EColor::WHITE ? " w " : " b ";
+
+        const std::uint8_t rights = board.GetCastlingRights();
+        if (rights == 0) {
+            fen += '-';
+        } else {
+            if (rights & WhiteKingSide) fen += 'K';
+            if (rights & WhiteQueenSide) fen += 'Q';
+            if (rights & BlackKingSide) fen += 'k';
+            if (rights & BlackQueenSide) fen += 'q';
+        }
+
+        fen += ' ';
+        const TSquare enPassant = board.GetEnPassantSquare();
+        if (enPassant == NoSquare) {
+            fen += '-';
+        } else {
+            fen += static_cast<char>('a' + enPassant % 8);
+            fen += static_cast<char>('1' + enPassant / 8);
+        }
+
+        fen += ' ';
+        fen += std::to_string(board.GetHalfmoveClock());
+        fen += ' ';
+        fen += std::to_string(board.GetMovesNumber() / 2 + 1);
+        return fen;
+    }
+}
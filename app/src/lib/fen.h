@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "chess_board.h"
+
+namespace NChess {
+
+    extern const std::string_view StartFen;
+
+    // Parses the position in place without building intermediate strings. The
+    // halfmove and fullmove fields may be omitted (EPD style). On failure the
+    // board is left cleared or partially set up and false is returned.
+    bool LoadFen(TBoard& board, std::string_view fen);
+
+    std::string ToFen(const TPosition& board);
+}
@@ -0,0 +1,459 @@
+#include "game_server.h"
+#include "fen.h"
+#include "move_generator.h"
+#include "uci.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace NChess {
+
+    namespace {
+        constexpr std::size_t MaxLineLength = 4096;
+        constexpr int MaxEvents = 256;
+        constexpr int AcceptRetryMs = 100;
+
+        bool ParseId(const std::string& text, std::uint64_t& id) {
+            if (text.empty() || text.size() > 20 || !std::all_of(text.begin(), text.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+                return false;
+            }
+            errno = 0;
+            const unsigned long long value = std::strtoull(text.c_str(), nullptr, 10);
+            if (errno == ERANGE) {
+                return false;
+            }
+            id = value;
+            return true;
+        }
+
+        void WatchFd(int epollFd, int operation, int fd, std::uint32_t events) {
+            epoll_event event{};
+            event.events = events;
+            event.data.fd = fd;
+            ::epoll_ctl(epollFd, operation, fd, &event);
+        }
+    }
+
+    std::uint32_t TGameSlab::Allocate() {
+        if (Used == MaxGames) {
+            return NoSlot;
+        }
+        if (FreeSlots.empty()) {
+            const std::uint32_t first = static_cast<std::uint32_t>(Chunks.size() * ChunkSize);
+            Chunks.push_back(std::make_unique<TGame[]>(ChunkSize));
+            for (std::size_t i = ChunkSize; i-- > 0;) {
+                FreeSlots.push_back(first + static_cast<std::uint32_t>(i));
+            }
+        }
+        const std::uint32_t slot = FreeSlots.back();
+        FreeSlots.pop_back();
+        TGame& game = Get(slot);
+        game.InUse = true;
+        game.Busy = false;
+        game.Orphaned = false;
+        ++Used;
+        return slot;
+    }
+
+    void TGameSlab::Release(std::uint32_t slot) {
+        TGame& game = Get(slot);
+        game.InUse = false;
+        game.Owner = -1;
+        ++game.Generation;
+        FreeSlots.push_back(slot);
+        --Used;
+    }
+
+    TGameSlab::TGame* TGameSlab::Find(std::uint64_t id) {
+        const std::uint32_t slot = static_cast<std::uint32_t>(id);
+        if (slot >= Chunks.size() * ChunkSize) {
+            return nullptr;
+        }
+        TGame& game = Get(slot);
+        return game.InUse && game.Generation == static_cast<std::uint32_t>(id >> 32) ? &game : nullptr;
+    }
+
+    TGameServer::TGameServer(const std::string& socketPath, const TSearchLimits& engineLimits, std::size_t maxGames,
+        std::size_t hashMb)
+        : SocketPath(socketPath)
+        , EngineLimits(engineLimits)
+        , Games(maxGames)
+        , ListenFd(-1)
+        , EpollFd(-1)
+        , WakeFd(-1)
+        , ListenPaused(false)
+        , Stopping(false)
+    {
+        const int workers = std::max(1, EngineLimits.Threads);
+        EngineLimits.Threads = 1;
+        for (int i = 0; i < workers; ++i) {
+            FreeTables.push_back(std::make_unique<TTranspositionTable>(hashMb, workers));
+        }
+        Pool = std::make_unique<TThreadPool>(workers);
+        WakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    }
+
+    TGameServer::~TGameServer() {
+        Pool.reset();
+        for (const auto& connection : Connections) {
+            ::close(connection.first);
+        }
+        if (ListenFd >= 0) {
+            ::close(ListenFd);
+            ::unlink(SocketPath.c_str());
+        }
+        if (EpollFd >= 0) {
+            ::close(EpollFd);
+        }
+        if (WakeFd >= 0) {
+            ::close(WakeFd);
+        }
+    }
+
+    void TGameServer::Stop() {
+        Stopping = true;
+        const std::uint64_t one = 1;
+        [[maybe_unused]] const ssize_t written = ::write(WakeFd, &one, sizeof(one));
+    }
+
+    bool TGameServer::Run() {
+        sockaddr_un address{};
+        if (WakeFd < 0 || SocketPath.empty() || SocketPath.size() >= sizeof(address.sun_path)) {
+            return false;
+        }
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, SocketPath.c_str(), SocketPath.size() + 1);
+        ::unlink(SocketPath.c_str());
+        ListenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (ListenFd < 0 || ::bind(ListenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0
+                || ::listen(ListenFd, SOMAXCONN) != 0) {
+            return false;
+        }
+        EpollFd = ::epoll_create1(EPOLL_CLOEXEC);
+        if (EpollFd < 0) {
+            return false;
+        }
+        WatchFd(EpollFd, EPOLL_CTL_ADD, ListenFd, EPOLLIN);
+        WatchFd(EpollFd, EPOLL_CTL_ADD, WakeFd, EPOLLIN);
+
+        std::array<epoll_event, MaxEvents> events;
+        while (!Stopping) {
+            const int ready = ::epoll_wait(EpollFd, events.data(), MaxEvents, ListenPaused ? AcceptRetryMs : -1);
+            if (ready < 0 && errno != EINTR) {
+                return false;
+            }
+            if (ready == 0) {
+                ResumeAccept();
+            }
+            for (int i = 0; i < ready; ++i) {
+                const int fd = events[i].data.fd;
+                if (fd == ListenFd) {
+                    Accept();
+                } else if (fd == WakeFd) {
+                    std::uint64_t count = 0;
+                    [[maybe_unused]] const ssize_t got = ::read(WakeFd, &count, sizeof(count));
+                    DrainCompletions();
+                } else if (Connections.count(fd) != 0) {
+                    if (events[i].events & EPOLLOUT) {
+                        Flush(fd);
+                    }
+                    if (Connections.count(fd) != 0 && events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR | EPOLLRDHUP)) {
+                        Read(fd);
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    void TGameServer::Accept() {
+        while (true) {
+            const int fd = ::accept4(ListenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                // Out of descriptors the pending connection stays queued and
+                // the level-triggered listener would fire again at once, so
+                // stop watching it until a connection closes or a retry
+                // interval passes.
+                if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                    ListenPaused = true;
+                    WatchFd(EpollFd, EPOLL_CTL_MOD, ListenFd, 0);
+                }
+                return;
+            }
+            Connections[fd];
+            WatchFd(EpollFd, EPOLL_CTL_ADD, fd, EPOLLIN | EPOLLRDHUP);
+        }
+    }
+
+    void TGameServer::ResumeAccept() {
+        if (ListenPaused) {
+            ListenPaused = false;
+            WatchFd(EpollFd, EPOLL_CTL_MOD, ListenFd, EPOLLIN);
+        }
+    }
+
+    // Lines that arrived before end of file are still executed.
+    void TGameServer::Read(int fd) {
+        std::array<char, 16384> buffer;
+        bool closed = false;
+        while (true) {
+            const ssize_t got = ::read(fd, buffer.data(), buffer.size());
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            if (got <= 0) {
+                closed = got == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+                break;
+            }
+            Connections[fd].Input.append(buffer.data(), static_cast<std::size_t>(got));
+        }
+
+        // Commands may close the connection, so it is looked up again for each line.
+        std::size_t start = 0;
+        while (true) {
+            const auto connection = Connections.find(fd);
+            if (connection == Connections.end()) {
+                return;
+            }
+            std::string& input = connection->second.Input;
+            const std::size_t end = input.find('\n', start);
+            if (end == std::string::npos) {
+                input.erase(0, start);
+                if (input.size() > MaxLineLength) {
+                    Reply(fd, "error line too long");
+                    Flush(fd);
+                    closed = true;
+                }
+                if (closed) {
+                    CloseConnection(fd);
+                }
+                return;
+            }
+            std::string line = input.substr(start, end - start);
+            start = end + 1;
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            Execute(fd, line);
+        }
+    }
+
+    void TGameServer::Reply(int fd, std::string_view line) {
+        const auto found = Connections.find(fd);
+        if (found != Connections.end()) {
+            found->second.Output.append(line);
+            found->second.Output.push_back('\n');
+        }
+    }
+
+    void TGameServer::Flush(int fd) {
+        const auto found = Connections.find(fd);
+        if (found == Connections.end()) {
+            return;
+        }
+        TConnection& connection = found->second;
+        std::size_t sent = 0;
+        while (sent < connection.Output.size()) {
+            const ssize_t written = ::send(fd, connection.Output.data() + sent, connection.Output.size() - sent, MSG_NOSIGNAL);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    CloseConnection(fd);
+                    return;
+                }
+                break;
+            }
+            sent += static_cast<std::size_t>(written);
+        }
+        connection.Output.erase(0, sent);
+        const bool writing = !connection.Output.empty();
+        if (writing != connection.Writing) {
+            connection.Writing = writing;
+            WatchFd(EpollFd, EPOLL_CTL_MOD, fd, EPOLLIN | EPOLLRDHUP | (writing ? EPOLLOUT : 0));
+        }
+    }
+
+    void TGameServer::CloseConnection(int fd) {
+        const auto found = Connections.find(fd);
+        if (found == Connections.end()) {
+            return;
+        }
+        for (std::uint32_t slot : found->second.Games) {
+            TGameSlab::TGame& game = Games.Get(slot);
+            if (game.Busy) {
+                game.Orphaned = true;
+                game.Owner = -1;
+            } else {
+                Games.Release(slot);
+            }
+        }
+        Connections.erase(found);
+        ::epoll_ctl(EpollFd, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        ResumeAccept();
+    }
+
+    void TGameServer::ReleaseGame(std::uint32_t slot) {
+        TGameSlab::TGame& game = Games.Get(slot);
+        const auto owner = Connections.find(game.Owner);
+        if (owner != Connections.end()) {
+            std::vector<std::uint32_t>& owned = owner->second.Games;
+            owned.erase(std::remove(owned.begin(), owned.end(), slot), owned.end());
+        }
+        Games.Release(slot);
+    }
+
+    TGameSlab::TGame* TGameServer::FindOwned(int fd, std::uint64_t id) {
+        TGameSlab::TGame* game = Games.Find(id);
+        return game != nullptr && game->Owner == fd ? game : nullptr;
+    }
+
+    void TGameServer::Execute(int fd, std::string_view line) {
+        std::istringstream input{std::string(line)};
+        std::string command, idText;
+        input >> command;
+        if (command.empty()) {
+            return;
+        }
+        if (command == "quit") {
+            Flush(fd);
+            CloseConnection(fd);
+            return;
+        }
+        if (command == "stats") {
+            Reply(fd, "ok games " + std::to_string(Games.GetUsed())
+                + " max_games " + std::to_string(Games.GetMaxGames())
+                + " connections " + std::to_string(Connections.size()));
+        } else if (command == "new") {
+            std::string keyword, token, fen;
+            input >> keyword;
+            while (input >> token) {
+                fen += fen.empty() ? token : " " + token;
+            }
+            const bool valid = keyword.empty() || (keyword == "fen" && !fen.empty());
+            const std::uint32_t slot = valid ? Games.Allocate() : TGameSlab::NoSlot;
+            if (!valid) {
+                Reply(fd, "error usage: new [fen <FEN>]");
+            } else if (slot == TGameSlab::NoSlot) {
+                Reply(fd, "error too many games");
+            } else {
+                TGameSlab::TGame& game = Games.Get(slot);
+                if (!LoadFen(game.Board, fen.empty() ? StartFen : std::string_view(fen))) {
+                    Games.Release(slot);
+                    Reply(fd, "error invalid fen");
+                } else {
+                    game.Owner = fd;
+                    Connections[fd].Games.push_back(slot);
+                    Reply(fd, "ok " + std::to_string(Games.MakeId(slot)));
+                }
+            }
+        } else {
+            std::uint64_t id = 0;
+            input >> idText;
+            TGameSlab::TGame* game = ParseId(idText, id) ? FindOwned(fd, id) : nullptr;
+            if (game == nullptr) {
+                Reply(fd, "error unknown game " + idText);
+            } else if (game->Busy) {
+                Reply(fd, "error game " + idText + " is busy");
+            } else if (command == "move") {
+                std::string text;
+                input >> text;
+                TMove move;
+                if (!ParseUciMove(game->Board, text, move)) {
+                    Reply(fd, "error illegal move " + text);
+                } else {
+                    game->Board.MovePiece(move);
+                    Reply(fd, "ok");
+                }
+            } else if (command == "undo") {
+                Reply(fd, game->Board.UndoMove() ? "ok" : "error no moves to undo");
+            } else if (command == "moves") {
+                TMoveList moves;
+                GenerateMoves(game->Board, game->Board.GetSideToMove(), moves);
+                std::string reply = "ok";
+                for (const TMove& move : moves) {
+                    reply += ' ';
+                    reply += MoveToUci(move);
+                }
+                Reply(fd, reply);
+            } else if (command == "fen") {
+                Reply(fd, "ok " + ToFen(game->Board));
+            } else if (command == "engine") {
+                StartEngine(static_cast<std::uint32_t>(id));
+            } else if (command == "close") {
+                ReleaseGame(static_cast<std::uint32_t>(id));
+                Reply(fd, "ok");
+            } else {
+                Reply(fd, "error unknown command " + command);
+            }
+        }
+        Flush(fd);
+    }
+
+    // The board is searched in place by a pool worker; the game stays busy,
+    // so no command touches it until the completion has been applied.
+    void TGameServer::StartEngine(std::uint32_t slot) {
+        TGameSlab::TGame& game = Games.Get(slot);
+        game.Busy = true;
+        const TBoard* board = &game.Board;
+        const std::uint32_t generation = game.Generation;
+        Pool->Submit([this, board, slot, generation]() {
+            std::unique_ptr<TTranspositionTable> table;
+            {
+                std::lock_guard<std::mutex> guard(TablesLock);
+                table = std::move(FreeTables.back());
+                FreeTables.pop_back();
+            }
+            TCompletion completion{slot, generation, ParallelSearch(*board, *table, EngineLimits)};
+            {
+                std::lock_guard<std::mutex> guard(TablesLock);
+                FreeTables.push_back(std::move(table));
+            }
+            {
+                std::lock_guard<std::mutex> guard(CompletionsLock);
+                Completions.push_back(completion);
+            }
+            const std::uint64_t one = 1;
+            [[maybe_unused]] const ssize_t written = ::write(WakeFd, &one, sizeof(one));
+        });
+    }
+
+    void TGameServer::DrainCompletions() {
+        std::vector<TCompletion> completions;
+        {
+            std::lock_guard<std::mutex> guard(CompletionsLock);
+            completions.swap(Completions);
+        }
+        for (const TCompletion& completion : completions) {
+            TGameSlab::TGame& game = Games.Get(completion.Slot);
+            if (!game.InUse || game.Generation != completion.Generation) {
+                continue;
+            }
+            game.Busy = false;
+            if (game.Orphaned) {
+                Games.Release(completion.Slot);
+                continue;
+            }
+            const std::string id = std::to_string(Games.MakeId(completion.Slot));
+            if (!completion.Result.HasMove) {
+                Reply(game.Owner, "bestmove " + id + " none");
+            } else {
+                game.Board.MovePiece(completion.Result.BestMove);
+                Reply(game.Owner, "bestmove " + id + " " + MoveToUci(completion.Result.BestMove));
+            }
+            Flush(game.Owner);
+        }
+    }
+}
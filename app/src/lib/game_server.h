@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "chess_board.h"
+#include "search.h"
+#include "thread_pool.h"
+#include "transposition_table.h"
+
+namespace NChess {
+
+    // Game slots carved out of fixed-size chunks. Chunks are never moved or
+    // freed, so a slot's board stays at one address for the slab's lifetime
+    // and released slots are reused before a new chunk is allocated.
+    class TGameSlab {
+        public:
+            struct TGame {
+                TBoard Board;
+                std::uint32_t Generation = 0;   // bumped on release, so stale ids miss
+                int Owner = -1;                 // connection descriptor
+                bool InUse = false;
+                bool Busy = false;              // engine search running on the board
+                bool Orphaned = false;          // owner left during the search
+            };
+            static constexpr std::uint32_t NoSlot = ~std::uint32_t(0);
+        private:
+            static constexpr std::size_t ChunkSize = 64;
+            std::vector<std::unique_ptr<TGame[]>> Chunks;
+            std::vector<std::uint32_t> FreeSlots;
+            std::size_t MaxGames;
+            std::size_t Used;
+        public:
+            explicit TGameSlab(std::size_t maxGames)
+                : MaxGames(maxGames)
+                , Used(0)
+            {
+            }
+            std::uint32_t Allocate();
+            void Release(std::uint32_t slot);
+            TGame& Get(std::uint32_t slot) {
+                return Chunks[slot / ChunkSize][slot % ChunkSize];
+            }
+            // Game ids carry the slot generation, so an id of a closed game
+            // never reaches the game that reuses its slot.
+            std::uint64_t MakeId(std::uint32_t slot) {
+                return static_cast<std::uint64_t>(Get(slot).Generation) << 32 | slot;
+            }
+            TGame* Find(std::uint64_t id);
+            std::size_t GetUsed() const {
+                return Used;
+            }
+            std::size_t GetMaxGames() const {
+                return MaxGames;
+            }
+    };
+
+    // Hosts many games in one process behind a Unix stream socket. Clients
+    // send one command per line and get one "ok ..." or "error ..." line per
+    // command; engine moves are searched on a thread pool and reported later
+    // as "bestmove <id> <move>". A game belongs to the connection that created
+    // it and is released when that connection closes.
+    //
+    //   new [fen <FEN>]     -> ok <id>
+    //   move <id> <uci>     -> ok
+    //   undo <id>           -> ok
+    //   moves <id>          -> ok <uci>...
+    //   fen <id>            -> ok <FEN>
+    //   engine <id>         -> bestmove <id> <uci> (asynchronous)
+    //   close <id>          -> ok
+    //   stats               -> ok games <n> max_games <n> connections <n>
+    //   quit
+    class TGameServer {
+        private:
+            struct TConnection {
+                std::string Input;
+                std::string Output;
+                std::vector<std::uint32_t> Games;
+                bool Writing = false;
+            };
+            struct TCompletion {
+                std::uint32_t Slot;
+                std::uint32_t Generation;
+                TSearchResult Result;
+            };
+
+            std::string SocketPath;
+            TSearchLimits EngineLimits;
+            TGameSlab Games;
+            std::unordered_map<int, TConnection> Connections;
+            int ListenFd;
+            int EpollFd;
+            int WakeFd;
+            bool ListenPaused;
+            std::atomic<bool> Stopping;
+            std::mutex CompletionsLock;
+            std::vector<TCompletion> Completions;
+            std::mutex TablesLock;
+            std::vector<std::unique_ptr<TTranspositionTable>> FreeTables;
+            std::unique_ptr<TThreadPool> Pool;    // declared last: joined before the rest is torn down
+
+            void Accept();
+            void ResumeAccept();
+            void Read(int fd);
+            void Flush(int fd);
+            void CloseConnection(int fd);
+            void Reply(int fd, std::string_view line);
+            void Execute(int fd, std::string_view line);
+            TGameSlab::TGame* FindOwned(int fd, std::uint64_t id);
+            void StartEngine(std::uint32_t slot);
+            void DrainCompletions();
+            void ReleaseGame(std::uint32_t slot);
+        public:
+            // 'engineLimits.Threads' sizes the search pool; every search
+            // itself runs single-threaded on a worker table holding an equal
+            // share of 'hashMb', which must be at least one megabyte per
+            // worker. Tables keep their entries between searches and only
+            // age them.
+            TGameServer(const std::string& socketPath, const TSearchLimits& engineLimits, std::size_t maxGames,
+                std::size_t hashMb = TTranspositionTable::DefaultSizeMb);
+            TGameServer(const TGameServer&) = delete;
+            TGameServer& operator=(const TGameServer&) = delete;
+            ~TGameServer();
+            // Binds the socket and serves until Stop(); false if the socket
+            // cannot be set up.
+            bool Run();
+            // Safe to call from another thread or a signal handler.
+            void Stop();
+    };
+}
@@ -0,0 +1,51 @@
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace NChess {
+
+    TMappedFile::~TMappedFile() {
+        Close();
+    }
+
+    bool TMappedFile::Open(const std::string& path, bool sequential) {
+        Close();
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            return false;
+        }
+        Size = static_cast<std::size_t>(info.st_size);
+        if (Size == 0) {
+            ::close(fd);
+            return true;
+        }
+        void* address = ::mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (address == MAP_FAILED) {
+            Size = 0;
+            return false;
+        }
+        if (sequential) {
+            ::madvise(address, Size, MADV_SEQUENTIAL);
+            ::madvise(address, Size, MADV_WILLNEED);
+        }
+        Data = static_cast<const char*>(address);
+        return true;
+    }
+
+    void TMappedFile::Close() {
+        if (Data != nullptr) {
+            ::munmap(const_cast<char*>(Data), Size);
+        }
+        Data = nullptr;
+        Size = 0;
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace NChess {
+
+    // Read-only memory mapping of a whole file, unmapped on destruction.
+    class TMappedFile {
+        private:
+            const char* Data;
+            std::size_t Size;
+        public:
+            TMappedFile()
+                : Data(nullptr)
+                , Size(0)
+            {
+            }
+            TMappedFile(const TMappedFile&) = delete;
+            TMappedFile& operator=(const TMappedFile&) = delete;
+            ~TMappedFile();
+            // 'sequential' hints the kernel to read ahead aggressively.
+            bool Open(const std::string& path, bool sequential = false);
+            void Close();
+            std::string_view GetData() const {
+                return {Data, Size};
+            }
+            std::size_t GetSize() const {
+                return Size;
+            }
+    };
+}
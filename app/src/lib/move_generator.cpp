@@ -0,0 +1,75 @@
+#include "move_generator.h"
+#include "attacks.h"
+
+namespace NChess {
+
+    namespace {
+        constexpr TBitboard PromotionRanks = 0xFF000000000000FFULL;
+        constexpr std::array<EType, 4> Promotions {EType::QUEEN, EType::KNIGHT, EType::ROOK, EType::BISHOP};
+
+        void AddMoves(const TPosition& board, TSquare from, TBitboard targets, TMoveList& moves) {
+            while (targets) {
+                moves.Add(board.CreateMove(from, PopLowestSquare(targets)));
+            }
+        }
+
+        void AddPawnMoves(const TPosition& board, TSquare from, TBitboard targets, TMoveList& moves) {
+            AddMoves(board, from, targets & ~PromotionRanks, moves);
+            targets &= PromotionRanks;
+            while (targets) {
+                const TSquare to = PopLowestSquare(targets);
+                for (EType promotion : Promotions) {
+                    moves.Add(board.CreateMove(from, to, promotion));
+                }
+            }
+        }
+    }
+
+    bool IsLegal(const TPosition& board, TMove move) {
+        const EColor color = board.GetPiece(move.GetFrom())->Color;
+        if (color == EColor::EMPTY) {
+            return false;
+        }
+        const TLegalityMasks masks = ComputeLegalityMasks(board, color);
+        return (LegalTargets(board, masks, move.GetFrom()) & SquareBit(move.GetTo())) != 0;
+    }
+
+    void GenerateMoves(const TPosition& board, EColor color, TMoveList& moves) {
+        const TLegalityMasks masks = ComputeLegalityMasks(board, color);
+        if (masks.CheckMask == 0) {
+            AddMoves(board, masks.KingSquare, LegalTargets(board, masks, masks.KingSquare), moves);
+            return;
+        }
+
+        TBitboard pawns = board.GetPieces(color, EType::PAWN);
+        while (pawns) {
+            const TSquare from = PopLowestSquare(pawns);
+            AddPawnMoves(board, from, LegalTargets(board, masks, from), moves);
+        }
+
+        TBitboard pieces = board.GetPieces(color) & ~board.GetPieces(color, EType::PAWN);
+        while (pieces) {
+            const TSquare from = PopLowestSquare(pieces);
+            AddMoves(board, from, LegalTargets(board, masks, from), moves);
+        }
+    }
+
+    std::uint64_t Perft(TPosition& board, EColor color, int depth) {
+        if (depth == 0) {
+            return 1;
+        }
+        TMoveList moves;
+        GenerateMoves(board, color, moves);
+        if (depth == 1) {
+            return moves.Size;
+        }
+        std::uint64_t nodes = 0;
+        for (const TMove& move : moves) {
+            TUndo undo;
+            board.MakeMove(move, undo);
+            nodes += Perft(board, Opponent(color), depth - 1);
+            board.UnmakeMove(undo);
+        }
+        return nodes;
+    }
+}
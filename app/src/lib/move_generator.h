@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "chess_board.h"
+#include "chess_piece.h"
+#include "move_rules.h"
+
+namespace NChess {
+
+    // 218 is the largest number of legal moves known for a chess position.
+    constexpr int MaxMovesNumber = 256;
+
+    struct TMoveList {
+        std::array<TMove, MaxMovesNumber> Moves;
+        int Size = 0;
+
+        void Add(TMove move) {
+            Moves[Size++] = move;
+        }
+        TMove* begin() {
+            return Moves.data();
+        }
+        TMove* end() {
+            return Moves.data() + Size;
+        }
+        const TMove* begin() const {
+            return Moves.data();
+        }
+        const TMove* end() const {
+            return Moves.data() + Size;
+        }
+    };
+
+    // True if the move is legal in the current position, including king safety.
+    bool IsLegal(const TPosition& board, TMove move);
+
+    // Legal moves only: check evasions and pins come from one TLegalityMasks
+    // per position, so no move is made and unmade to test it.
+    void GenerateMoves(const TPosition& board, EColor color, TMoveList& moves);
+
+    std::uint64_t Perft(TPosition& board, EColor color, int depth);
+}
@@ -1,201 +1,242 @@
 #include "move_rules.h"
+#include "attacks.h"
+#include "stats.h"
 
-namespace NChess {
-
-    TCell FrontMove(TCell from) {
-        return {from.file, NextRankMap.at(from.rank)};
-    }
-
-    TCell BackMove(TCell from) {
-        return {from.file, PrevRankMap.at(from.rank)};
-    }
-
-    TCell RightMove(TCell from) {
-        return {NextFileMap.at(from.file), from.rank};
-    }
-
-    TCell LeftMove(TCell from) {
-        return {PrevFileMap.at(from.file), from.rank};
-    }
-
-    TCell FrontRightMove(TCell from) {
-        return {NextFileMap.at(from.file), NextRankMap.at(from.rank)};
-    }
-
-    TCell FrontLeftMove(TCell from) {
-        return {PrevFileMap.at(from.file), NextRankMap.at(from.rank)};
-    }
-
-    TCell BackRightMove(TCell from) {
-        return {NextFileMap.at(from.file), PrevRankMap.at(from.rank)};
-    }
+#include <utility>
 
-    TCell BackLeftMove(TCell from) {
-        return {PrevFileMap.at(from.file), PrevRankMap.at(from.rank)};
-    }
+namespace NChess {
 
-    bool IsEmpty(TCell cell, const TBoard& board) {
-        auto piece = board.GetPiece(cell);
-        return piece->Type == EType::EMPTY;
-    }
+    namespace {
+        struct TCastlingRule {
+            std::uint8_t Right;
+            TSquare KingFrom;
+            TSquare KingTo;
+            TSquare RookFrom;
+            TBitboard Empty;    // squares between king and rook
+            TBitboard Safe;     // squares the king crosses or lands on
+        };
 
-    bool OutBound(TCell cell) {
-        return cell.rank == ERank::END || cell.rank == ERank::BEGIN || cell.file == EFile::END || cell.file == EFile::BEGIN;
-    }
+        constexpr std::array<TCastlingRule, 4> CastlingRules {{
+            {WhiteKingSide, 4, 6, 7, SquareBit(5) | SquareBit(6), SquareBit(5) | SquareBit(6)},
+            {WhiteQueenSide, 4, 2, 0, SquareBit(1) | SquareBit(2) | SquareBit(3), SquareBit(2) | SquareBit(3)},
+            {BlackKingSide, 60, 62, 63, SquareBit(61) | SquareBit(62), SquareBit(61) | SquareBit(62)},
+            {BlackQueenSide, 60, 58, 56, SquareBit(57) | SquareBit(58) | SquareBit(59), SquareBit(58) | SquareBit(59)},
+        }};
+
+        template <EColor Color>
+        TBitboard PawnTargets(const TPosition& board, TSquare from) {
+            constexpr int Direction = Color == EColor::WHITE ? 8 : -8;
+            constexpr int StartRank = Color == EColor::WHITE ? 1 : 6;
+            constexpr EColor Enemy = Color == EColor::WHITE ? EColor::BLACK : EColor::WHITE;
+            const TBitboard occupied = board.GetOccupied();
+            TBitboard targets = PawnAttacks(from, Color) & board.GetPieces(Enemy);
+            const TSquare single = from + Direction;
+            if (single >= 0 && single < SquaresNumber && !(occupied & SquareBit(single))) {
+                targets |= SquareBit(single);
+                if (from / 8 == StartRank && !(occupied & SquareBit(single + Direction))) {
+                    targets |= SquareBit(single + Direction);
+                }
+            }
+            return targets;
+        }
 
-    template<typename F>
-    bool SweepThrough(TCell from, TCell to, F nextmove, EColor color, const TBoard& board) {
-        
-        TCell next = from;        
-        while (next != to) {
-            next = nextmove(next);
-            if(OutBound(next)) {
-                return false;                
+        // En passant removes two pawns from one rank, so it is checked by
+        // replaying the occupancy change instead of through the pin masks.
+        template <EColor Color>
+        TBitboard EnPassantTarget(const TPosition& board, const TLegalityMasks& masks, TSquare from) {
+            constexpr EColor Enemy = Color == EColor::WHITE ? EColor::BLACK : EColor::WHITE;
+            const TSquare target = board.GetEnPassantSquare();
+            if (target == NoSquare || !(PawnAttacks(from, Color) & SquareBit(target))) {
+                return 0;
             }
-            if(IsEmpty(next, board) && next == to) {
-                return true;
+            const TSquare captured = from / 8 * 8 + target % 8;
+            if (!(board.GetPieces(Enemy, EType::PAWN) & SquareBit(captured))) {
+                return 0;
             }
-            if(!IsEmpty(next, board) && next != to) {
-                return false;
-            } 
-            if(!IsEmpty(next, board) && next == to && board.GetPiece(next)->Color != color) {
-                return true;
-            } 
-            if(!IsEmpty(next, board) && next == to && board.GetPiece(next)->Color == color) {
-                return false;
+            if (masks.KingSquare == NoSquare) {
+                return SquareBit(target);
             }
-        }        
-        return true;
-    }
-
-    bool PawnCanMove(TCell from, TCell to, EColor color, const TBoard& board) {
-        TCell next;
-        auto canAttack = [&to, &board, &color](TCell next) {
-            return next == to && !IsEmpty(next, board) && board.GetPiece(next)->Color != color;
-        };        
-
-        if (color == EColor::WHITE) {
-            next = FrontMove(from);
-            if(next == to) return IsEmpty(next, board);
-            
-            if(from.rank == ERank::R2 && FrontMove(next) == to) return IsEmpty(next, board);
-
-            if(canAttack(FrontLeftMove(from))) return true;
-            if(canAttack(FrontRightMove(from))) return true;
-        } else {
-            next = BackMove(from);
-            if (next == to) return IsEmpty(next, board);
-
-            if (from.rank == ERank::R7 && BackMove(next) == to) return IsEmpty(next, board);                               
-
-            if (canAttack(BackLeftMove(from))) return true;
-            if (canAttack(BackRightMove(from))) return true;
+            const TBitboard occupied = (board.GetOccupied() ^ SquareBit(from) ^ SquareBit(captured)) | SquareBit(target);
+            const TBitboard attackers = AttackersTo(board, masks.KingSquare, Enemy, occupied) & ~SquareBit(captured);
+            return attackers ? 0 : SquareBit(target);
         }
-        return false;
-    } 
 
-    bool BishopCanMove(TCell from, TCell to, EColor color, const TBoard& board) {        
-        
-        if(SweepThrough(from, to, FrontRightMove, color, board)) return true;
+        template <EColor Color>
+        TBitboard KingTargets(const TPosition& board, const TLegalityMasks& masks, TSquare from) {
+            constexpr EColor Enemy = Color == EColor::WHITE ? EColor::BLACK : EColor::WHITE;
+            constexpr std::size_t FirstRule = Color == EColor::WHITE ? 0 : 2;
+            const TBitboard occupied = board.GetOccupied() & ~SquareBit(from);
+            TBitboard candidates = KingAttacks(from) & ~board.GetPieces(Color);
+            TBitboard targets = 0;
+            while (candidates) {
+                const TSquare to = PopLowestSquare(candidates);
+                if (!AttackersTo(board, to, Enemy, occupied)) {
+                    targets |= SquareBit(to);
+                }
+            }
+            if (masks.Checkers) {
+                return targets;
+            }
+            const std::uint8_t rights = board.GetCastlingRights();
+            const TBitboard rooks = board.GetPieces(Color, EType::ROOK);
+            for (std::size_t i = FirstRule; i < FirstRule + 2; ++i) {
+                const TCastlingRule& rule = CastlingRules[i];
+                if (!(rights & rule.Right) || rule.KingFrom != from || !(rooks & SquareBit(rule.RookFrom))
+                        || (board.GetOccupied() & rule.Empty)) {
+                    continue;
+                }
+                bool safe = true;
+                TBitboard path = rule.Safe;
+                while (path && safe) {
+                    safe = !AttackersTo(board, PopLowestSquare(path), Enemy, board.GetOccupied());
+                }
+                if (safe) {
+                    targets |= SquareBit(rule.KingTo);
+                }
+            }
+            return targets;
+        }
 
-        if(SweepThrough(from, to, FrontLeftMove, color, board)) return true;
+        // One kernel per piece type and color, so pawn directions, castling
+        // rules and the attack function are fixed at compile time.
+        template <EType Type, EColor Color>
+        TBitboard PieceTargets(const TPosition& board, const TLegalityMasks& masks, TSquare from) {
+            if constexpr (Type == EType::EMPTY || Color == EColor::EMPTY) {
+                return 0;
+            } else if constexpr (Type == EType::KING) {
+                return KingTargets<Color>(board, masks, from);
+            } else {
+                const TBitboard own = board.GetPieces(Color);
+                TBitboard targets = 0;
+                if constexpr (Type == EType::PAWN) {
+                    targets = PawnTargets<Color>(board, from);
+                } else if constexpr (Type == EType::BISHOP) {
+                    targets = BishopAttacks(from, board.GetOccupied()) & ~own;
+                } else if constexpr (Type == EType::KNIGHT) {
+                    targets = KnightAttacks(from) & ~own;
+                } else if constexpr (Type == EType::ROOK) {
+                    targets = RookAttacks(from, board.GetOccupied()) & ~own;
+                } else {
+                    targets = QueenAttacks(from, board.GetOccupied()) & ~own;
+                }
+                targets &= masks.CheckMask;
+                if (masks.Pinned & SquareBit(from)) {
+                    targets &= LineThrough(masks.KingSquare, from);
+                }
+                if constexpr (Type == EType::PAWN) {
+                    targets |= EnPassantTarget<Color>(board, masks, from);
+                }
+                return targets;
+            }
+        }
 
-        if(SweepThrough(from, to, BackRightMove, color, board)) return true;
+        using TTargetsKernel = TBitboard (*)(const TPosition&, const TLegalityMasks&, TSquare);
 
-        if(SweepThrough(from, to, BackLeftMove, color, board)) return true;
+        template <std::size_t... Indexes>
+        constexpr std::array<TTargetsKernel, PiecesNumber> MakeTargetKernels(std::index_sequence<Indexes...>) {
+            return {{&PieceTargets<PieceTable[Indexes].Type, PieceTable[Indexes].Color>...}};
+        }
 
-        return false;
+        // Indexed like PieceTable, i.e. by the board's mailbox entries.
+        constexpr std::array<TTargetsKernel, PiecesNumber> TargetKernels =
+            MakeTargetKernels(std::make_index_sequence<PiecesNumber>());
     }
 
-    template<typename Func1, typename Func2>
-    bool KnightStep(TCell from, TCell to, Func1 step1, Func2 step2) {
-        TCell next;
-        next = step1(from);
-        if(OutBound(next)) return false;
-        next = step1(next);
-        if(OutBound(next)) return false;
-        next = step2(next);
-        return next == to;
+    TBitboard AttackersTo(const TPosition& board, TSquare square, EColor byColor, TBitboard occupied) {
+        const TBitboard queens = board.GetPieces(byColor, EType::QUEEN);
+        return ((PawnAttacks(square, Opponent(byColor)) & board.GetPieces(byColor, EType::PAWN))
+            | (KnightAttacks(square) & board.GetPieces(byColor, EType::KNIGHT))
+            | (KingAttacks(square) & board.GetPieces(byColor, EType::KING))
+            | (BishopAttacks(square, occupied) & (board.GetPieces(byColor, EType::BISHOP) | queens))
+            | (RookAttacks(square, occupied) & (board.GetPieces(byColor, EType::ROOK) | queens))) & occupied;
     }
 
-    bool KnightCanMove(TCell from, TCell to, EColor color, const TBoard& board) {
-        auto emptyOrEnemy = [&color, &board](TCell cell) {
-            return IsEmpty(cell, board) || board.GetPiece(cell)->Color != color;
-        };
-
-        if(!emptyOrEnemy(to)) return false;
-
-        if(KnightStep(from, to, FrontMove, RightMove)) return true;
-        
-        if(KnightStep(from, to, FrontMove, LeftMove)) return true;
-
-        if(KnightStep(from, to, BackMove, RightMove)) return true;
-        
-        if(KnightStep(from, to, BackMove, LeftMove)) return true;
-
-        if(KnightStep(from, to, RightMove, FrontMove)) return true;
-
-        if(KnightStep(from, to, RightMove, BackMove)) return true;
-
-        if(KnightStep(from, to, LeftMove, FrontMove)) return true;
-
-        if(KnightStep(from, to, LeftMove, BackMove)) return true;         
-
-        return false;
+    bool IsSquareAttacked(const TPosition& board, TSquare square, EColor byColor) {
+        return AttackersTo(board, square, byColor, board.GetOccupied()) != 0;
     }
 
-    bool RookCanMove(TCell from, TCell to, EColor color, const TBoard& board) {
-        
-        if(SweepThrough(from, to, FrontMove, color, board)) return true;
-
-        if(SweepThrough(from, to, BackMove, color, board)) return true;
-
-        if(SweepThrough(from, to, RightMove, color, board)) return true;
-
-        if(SweepThrough(from, to, LeftMove, color, board)) return true;
-
-        return false;
+    bool InCheck(const TPosition& board, EColor color) {
+        const TBitboard king = board.GetPieces(color, EType::KING);
+        return king != 0 && IsSquareAttacked(board, LowestSquare(king), Opponent(color));
     }
 
-    bool QueenCanMove(TCell from, TCell to, EColor color, const TBoard& board) {
-        return RookCanMove(from, to, color, board) || BishopCanMove(from, to, color, board);
+    TLegalityMasks ComputeLegalityMasks(const TPosition& board, EColor color) {
+        CLCHESS_STATS_SCOPE(LEGALITY_MASKS);
+        TLegalityMasks masks;
+        masks.Color = color;
+        const TBitboard king = board.GetPieces(color, EType::KING);
+        if (king == 0) {
+            return masks;
+        }
+        const EColor enemy = Opponent(color);
+        const TSquare kingSquare = LowestSquare(king);
+        const TBitboard occupied = board.GetOccupied();
+        masks.KingSquare = kingSquare;
+        masks.Checkers = AttackersTo(board, kingSquare, enemy, occupied);
+        if (masks.Checkers) {
+            masks.CheckMask = CountBits(masks.Checkers) > 1
+                ? 0
+                : masks.Checkers | BetweenSquares(kingSquare, LowestSquare(masks.Checkers));
+        }
+
+        // Enemy sliders that would attack the king through exactly one of our pieces pin it.
+        const TBitboard enemies = board.GetPieces(enemy);
+        const TBitboard queens = board.GetPieces(enemy, EType::QUEEN);
+        TBitboard snipers = (RookAttacks(kingSquare, enemies) & (board.GetPieces(enemy, EType::ROOK) | queens))
+            | (BishopAttacks(kingSquare, enemies) & (board.GetPieces(enemy, EType::BISHOP) | queens));
+        const TBitboard own = board.GetPieces(color);
+        while (snipers) {
+            const TBitboard blockers = BetweenSquares(kingSquare, PopLowestSquare(snipers)) & occupied;
+            if (CountBits(blockers) == 1 && (blockers & own)) {
+                masks.Pinned |= blockers;
+            }
+        }
+        return masks;
     }
 
-    bool KingCanMove(TCell from, TCell to, EColor color, const TBoard& board) {    
-        auto CanMakeMove = [&to, &board, &color](TCell next) {
-            return next == to && ((!IsEmpty(next, board) && board.GetPiece(next)->Color != color) || IsEmpty(next, board));
-        };   
-        return CanMakeMove(FrontMove(from))
-                || CanMakeMove(BackMove(from))
-                || CanMakeMove(LeftMove(from))
-                || CanMakeMove(RightMove(from))
-                || CanMakeMove(FrontLeftMove(from))
-                || CanMakeMove(FrontRightMove(from))
-                || CanMakeMove(BackLeftMove(from))
-                || CanMakeMove(BackRightMove(from));
+    TBitboard LegalTargets(const TPosition& board, const TLegalityMasks& masks, TSquare from) {
+        CLCHESS_STATS_SCOPE(LEGAL_TARGETS);
+        return TargetKernels[board.GetPiece(from) - PieceTable.data()](board, masks, from);
     }
 
-    bool PieceCanMove(TCell from, TCell to, const TBoard& board) {
-        const TChessPiece* piece = board.GetPiece(from);
-        if(piece->Type == EType::PAWN) {
-            return PawnCanMove(from, to, piece->Color, board);
+    bool PieceCanMove(TCell from, TCell to, const TPosition& board) {
+        CLCHESS_STATS_SCOPE(PIECE_CAN_MOVE);
+        const TSquare fromSquare = ToSquare(from);
+        const TChessPiece* piece = board.GetPiece(fromSquare);
+        if (piece->Color == EColor::EMPTY) {
+            return false;
         }
-        if(piece->Type == EType::BISHOP) {
-            return BishopCanMove(from, to, piece->Color, board);
-        }
-        if(piece->Type == EType::ROOK) {
-            return RookCanMove(from, to, piece->Color, board);
-        }
-        if(piece->Type == EType::KNIGHT) {
-            return KnightCanMove(from, to, piece->Color, board);
-        }
-        if(piece->Type == EType::QUEEN) {
-            return QueenCanMove(from, to, piece->Color, board);
-        }
-        if(piece->Type == EType::KING) {
-            return KingCanMove(from, to, piece->Color, board);
+        const TLegalityMasks masks = ComputeLegalityMasks(board, piece->Color);
+        return (LegalTargets(board, masks, fromSquare) & SquareBit(ToSquare(to))) != 0;
+    }
+
+    std::size_t PieceCanMoveBatch(const TPosition& board, const TMoveCandidate* candidates, std::size_t count, bool* legal) {
+        std::array<TLegalityMasks, 3> masks;
+        std::array<bool, 3> hasMasks{};
+        std::array<TBitboard, SquaresNumber> targets;
+        TBitboard resolved = 0;
+
+        std::size_t legalNumber = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            const TSquare from = candidates[i].From;
+            const TSquare to = candidates[i].To;
+            if (from < 0 || from >= SquaresNumber || to < 0 || to >= SquaresNumber) {
+                legal[i] = false;
+                continue;
+            }
+            if (!(resolved & SquareBit(from))) {
+                const EColor color = board.GetPiece(from)->Color;
+                const int colorIndex = static_cast<int>(color);
+                if (color != EColor::EMPTY && !hasMasks[colorIndex]) {
+                    masks[colorIndex] = ComputeLegalityMasks(board, color);
+                    hasMasks[colorIndex] = true;
+                }
+                targets[from] = color == EColor::EMPTY ? 0 : LegalTargets(board, masks[colorIndex], from);
+                resolved |= SquareBit(from);
+            }
+            legal[i] = (targets[from] >> to) & 1;
+            legalNumber += legal[i];
         }
-        return false;
+        return legalNumber;
     }
-
 }
@@ -1,8 +1,47 @@
 #pragma once
 
+#include <cstddef>
+
 #include "chess_board.h"
 #include "chess_piece.h"
 
 namespace NChess {
-    bool PieceCanMove(TCell from, TCell to, const TBoard& board);
+
+    // Pieces of 'byColor' attacking 'square' when the board is occupied by 'occupied'.
+    TBitboard AttackersTo(const TPosition& board, TSquare square, EColor byColor, TBitboard occupied);
+
+    bool IsSquareAttacked(const TPosition& board, TSquare square, EColor byColor);
+
+    bool InCheck(const TPosition& board, EColor color);
+
+    // Check and pin state of one side, computed once per position and shared
+    // by every move validated or generated in it. Without a king on the board
+    // nothing is pinned and no move can expose it.
+    struct TLegalityMasks {
+        EColor Color = EColor::EMPTY;
+        TSquare KingSquare = NoSquare;
+        TBitboard Checkers = 0;
+        TBitboard CheckMask = ~TBitboard(0);   // non-king moves must capture or block the checker
+        TBitboard Pinned = 0;
+    };
+
+    TLegalityMasks ComputeLegalityMasks(const TPosition& board, EColor color);
+
+    // All legal destinations of the piece on 'from', which must belong to
+    // masks.Color, including castling and en passant. A pawn move to the last
+    // rank is legal with any promotion piece.
+    TBitboard LegalTargets(const TPosition& board, const TLegalityMasks& masks, TSquare from);
+
+    bool PieceCanMove(TCell from, TCell to, const TPosition& board);
+
+    struct TMoveCandidate {
+        TSquare From;
+        TSquare To;
+    };
+
+    // PieceCanMove for many candidates of one position: legality masks are
+    // computed once per color and legal targets once per origin square, so
+    // each candidate costs a table lookup. legal[i] receives the verdict of
+    // candidates[i]; returns how many are legal.
+    std::size_t PieceCanMoveBatch(const TPosition& board, const TMoveCandidate* candidates, std::size_t count, bool* legal);
 }
@@ -0,0 +1,222 @@
+#include "opening_book.h"
+#include "attacks.h"
+#include "move_generator.h"
+#include "polyglot_random.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace NChess {
+
+    namespace {
+        constexpr std::array<EType, 5> PromotionTypes {EType::EMPTY, EType::KNIGHT, EType::BISHOP, EType::ROOK, EType::QUEEN};
+        // Polyglot piece order (pawn, knight, bishop, rook, queen, king) by EType.
+        constexpr std::array<int, 7> PolyglotTypes {0, 0, 2, 1, 3, 4, 5};
+
+        template <typename T>
+        T ReadBigEndian(const unsigned char* data) {
+            T value = 0;
+            for (std::size_t i = 0; i < sizeof(T); ++i) {
+                value = static_cast<T>((value << 8) | data[i]);
+            }
+            return value;
+        }
+
+        template <typename T>
+        void WriteBigEndian(unsigned char* data, T value) {
+            for (std::size_t i = sizeof(T); i-- > 0;) {
+                data[i] = static_cast<unsigned char>(value & 0xFF);
+                value = static_cast<T>(value >> 8);
+            }
+        }
+
+        // The legal board move for a Polyglot move, if there is one.
+        bool DecodeMove(const TPosition& board, std::uint16_t encoded, TMove& move) {
+            const TSquare from = (encoded >> 6) & 63;
+            TSquare to = encoded & 63;
+            const int promotionIndex = (encoded >> 12) & 7;
+            if (promotionIndex >= static_cast<int>(PromotionTypes.size())) {
+                return false;
+            }
+            const EType promotion = PromotionTypes[promotionIndex];
+            const TChessPiece* piece = board.GetPiece(from);
+            if (piece->Color != board.GetSideToMove()) {
+                return false;
+            }
+            const TChessPiece* target = board.GetPiece(to);
+            if (piece->Type == EType::KING && target->Type == EType::ROOK && target->Color == piece->Color) {
+                to = to > from ? from + 2 : from - 2;
+            }
+            const bool lastRank = to / 8 == 0 || to / 8 == 7;
+            if ((piece->Type == EType::PAWN && lastRank) != (promotion != EType::EMPTY)) {
+                return false;
+            }
+            move = board.CreateMove(from, to, promotion);
+            return IsLegal(board, move);
+        }
+    }
+
+    namespace NBook {
+        std::uint16_t EncodeMove(TMove move) {
+            const TSquare from = move.GetFrom();
+            TSquare to = move.GetTo();
+            if (move.GetFlag() == EMoveFlag::CASTLING) {
+                to = to > from ? from + 3 : from - 4;
+            }
+            const auto promotion = std::find(PromotionTypes.begin(), PromotionTypes.end(), move.GetPromotion());
+            const int promotionIndex = promotion == PromotionTypes.end() ? 0 : static_cast<int>(promotion - PromotionTypes.begin());
+            return static_cast<std::uint16_t>(to | (from << 6) | (promotionIndex << 12));
+        }
+
+        THash PolyglotKey(const TPosition& board) {
+            THash key = 0;
+            TBitboard occupied = board.GetOccupied();
+            while (occupied) {
+                const TSquare square = PopLowestSquare(occupied);
+                const TChessPiece* piece = board.GetPiece(square);
+                const int kind = 2 * PolyglotTypes[static_cast<int>(piece->Type)] + (piece->Color == EColor::WHITE ? 1 : 0);
+                key ^= Random64[64 * kind + square];
+            }
+            for (int right = 0; right < 4; ++right) {
+                if (board.GetCastlingRights() & (1 << right)) {
+                    key ^= Random64[RandomCastle + right];
+                }
+            }
+            const EColor color = board.GetSideToMove();
+            const TSquare enPassant = board.GetEnPassantSquare();
+            if (enPassant != NoSquare && (PawnAttacks(enPassant, Opponent(color)) & board.GetPieces(color, EType::PAWN))) {
+                key ^= Random64[RandomEnPassant + enPassant % 8];
+            }
+            if (color == EColor::WHITE) {
+                key ^= Random64[RandomTurn];
+            }
+            return key;
+        }
+    }
+
+    bool TOpeningBook::Open(const std::string& path) {
+        Entries = nullptr;
+        EntriesNumber = 0;
+        if (!File.Open(path) || File.GetSize() % NBook::EntrySize != 0) {
+            File.Close();
+            return false;
+        }
+        Entries = reinterpret_cast<const unsigned char*>(File.GetData().data());
+        EntriesNumber = File.GetSize() / NBook::EntrySize;
+        return true;
+    }
+
+    std::size_t TOpeningBook::LowerBound(THash key) const {
+        std::size_t low = 0;
+        std::size_t high = EntriesNumber;
+        while (low < high) {
+            const std::size_t middle = low + (high - low) / 2;
+            if (ReadBigEndian<std::uint64_t>(Entries + middle * NBook::EntrySize) < key) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        return low;
+    }
+
+    void TOpeningBook::Probe(const TPosition& board, TBookMoves& moves) const {
+        moves.Size = 0;
+        moves.TotalWeight = 0;
+        if (!IsOpen()) {
+            return;
+        }
+        const THash key = NBook::PolyglotKey(board);
+        for (std::size_t i = LowerBound(key); i < EntriesNumber && moves.Size < MaxBookMoves; ++i) {
+            const unsigned char* entry = Entries + i * NBook::EntrySize;
+            if (ReadBigEndian<std::uint64_t>(entry) != key) {
+                break;
+            }
+            TBookMove& bookMove = moves.Moves[moves.Size];
+            if (DecodeMove(board, ReadBigEndian<std::uint16_t>(entry + 8), bookMove.Move)) {
+                bookMove.Weight = ReadBigEndian<std::uint16_t>(entry + 10);
+                moves.TotalWeight += bookMove.Weight;
+                ++moves.Size;
+            }
+        }
+    }
+
+    bool TOpeningBook::ChooseMove(const TPosition& board, std::uint64_t random, TMove& move) const {
+        TBookMoves moves;
+        Probe(board, moves);
+        if (moves.Size == 0) {
+            return false;
+        }
+        move = moves.Moves[0].Move;
+        if (moves.TotalWeight == 0) {
+            return true;
+        }
+        std::uint64_t pick = random % moves.TotalWeight;
+        for (int i = 0; i < moves.Size; ++i) {
+            if (pick < moves.Moves[i].Weight) {
+                move = moves.Moves[i].Move;
+                break;
+            }
+            pick -= moves.Moves[i].Weight;
+        }
+        return true;
+    }
+
+    void TBookBuilder::Add(const TPosition& board, TMove move) {
+        Records.push_back({NBook::PolyglotKey(board), NBook::EncodeMove(move)});
+    }
+
+    bool TBookBuilder::Write(const std::string& path, std::uint32_t minCount, std::size_t& entries) {
+        struct TCounted {
+            std::uint16_t Move;
+            std::uint32_t Count;
+        };
+
+        std::sort(Records.begin(), Records.end(), [](const TRecord& a, const TRecord& b) {
+            return a.Key != b.Key ? a.Key < b.Key : a.Move < b.Move;
+        });
+        std::uint32_t maxCount = 1;
+        for (std::size_t i = 0, run = 1; i < Records.size(); ++i, ++run) {
+            if (i + 1 == Records.size() || Records[i + 1].Key != Records[i].Key || Records[i + 1].Move != Records[i].Move) {
+                maxCount = std::max(maxCount, static_cast<std::uint32_t>(run));
+                run = 0;
+            }
+        }
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        entries = 0;
+        std::vector<TCounted> group;
+        std::size_t i = 0;
+        while (i < Records.size()) {
+            const THash key = Records[i].Key;
+            group.clear();
+            for (; i < Records.size() && Records[i].Key == key; ++i) {
+                if (!group.empty() && group.back().Move == Records[i].Move) {
+                    ++group.back().Count;
+                } else {
+                    group.push_back({Records[i].Move, 1});
+                }
+            }
+            // Polyglot lists the moves of a position by decreasing weight.
+            std::stable_sort(group.begin(), group.end(), [](const TCounted& a, const TCounted& b) {
+                return a.Count > b.Count;
+            });
+            for (const TCounted& counted : group) {
+                if (counted.Count < minCount) {
+                    continue;
+                }
+                const std::uint64_t scaled = std::max<std::uint64_t>(1, std::uint64_t(counted.Count) * 0xFFFF / std::max<std::uint32_t>(maxCount, 0xFFFF));
+                unsigned char entry[NBook::EntrySize] = {};
+                WriteBigEndian<std::uint64_t>(entry, key);
+                WriteBigEndian<std::uint16_t>(entry + 8, counted.Move);
+                WriteBigEndian<std::uint16_t>(entry + 10, static_cast<std::uint16_t>(scaled));
+                out.write(reinterpret_cast<const char*>(entry), sizeof(entry));
+                ++entries;
+            }
+        }
+        return static_cast<bool>(out.flush());
+    }
+}
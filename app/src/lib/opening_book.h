@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "chess_board.h"
+#include "mapped_file.h"
+#include "zobrist.h"
+
+namespace NChess {
+
+    // Book files use the Polyglot format: 16-byte big-endian entries
+    // (key, move, weight, learn) sorted by Polyglot key, so books built by
+    // other tools can be read and books written here can be used elsewhere.
+    namespace NBook {
+        constexpr std::size_t EntrySize = 16;
+
+        // Polyglot move: to square in bits 0-5, from square in bits 6-11,
+        // promotion (1 knight .. 4 queen) in bits 12-14; castling is written
+        // as the king capturing its own rook.
+        std::uint16_t EncodeMove(TMove move);
+
+        // Polyglot key of the position. Unlike TPosition::GetHash(), the
+        // en-passant file only counts when a pawn of the side to move
+        // stands ready to capture.
+        THash PolyglotKey(const TPosition& board);
+    }
+
+    struct TBookMove {
+        TMove Move;
+        std::uint16_t Weight = 0;
+    };
+
+    // More moves than any real book holds for one position; extra entries
+    // are ignored.
+    constexpr int MaxBookMoves = 64;
+
+    struct TBookMoves {
+        std::array<TBookMove, MaxBookMoves> Moves;
+        int Size = 0;
+        std::uint32_t TotalWeight = 0;
+    };
+
+    // Read-only book over a memory-mapped file. Lookups binary-search the
+    // mapping and allocate nothing; only moves legal on the board are
+    // returned.
+    class TOpeningBook {
+        private:
+            TMappedFile File;
+            const unsigned char* Entries;
+            std::size_t EntriesNumber;
+            std::size_t LowerBound(THash key) const;
+        public:
+            TOpeningBook()
+                : Entries(nullptr)
+                , EntriesNumber(0)
+            {
+            }
+            bool Open(const std::string& path);
+            bool IsOpen() const {
+                return Entries != nullptr;
+            }
+            std::size_t GetEntriesNumber() const {
+                return EntriesNumber;
+            }
+            void Probe(const TPosition& board, TBookMoves& moves) const;
+            // Picks a book move with probability proportional to its weight;
+            // 'random' is any uniformly distributed value.
+            bool ChooseMove(const TPosition& board, std::uint64_t random, TMove& move) const;
+    };
+
+    // Collects (position, move) pairs, typically from a PGN corpus, and
+    // writes them as a sorted book weighted by how often each move was played.
+    class TBookBuilder {
+        private:
+            struct TRecord {
+                THash Key;
+                std::uint16_t Move;
+            };
+            std::vector<TRecord> Records;
+        public:
+            void Add(const TPosition& board, TMove move);
+            std::size_t GetRecordsNumber() const {
+                return Records.size();
+            }
+            // Moves played fewer than 'minCount' times are dropped; 'entries'
+            // receives the number of book entries written.
+            bool Write(const std::string& path, std::uint32_t minCount, std::size_t& entries);
+    };
+}
@@ -0,0 +1,401 @@
+#include "pgn.h"
+#include "fen.h"
+#include "move_generator.h"
+#include "move_rules.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+
+namespace NChess {
+
+    namespace {
+        EType PieceLetterToType(char c) {
+            switch (c) {
+                case 'N': return EType::KNIGHT;
+                case 'B': return EType::BISHOP;
+                case 'R': return EType::ROOK;
+                case 'Q': return EType::QUEEN;
+                case 'K': return EType::KING;
+                default: return EType::EMPTY;
+            }
+        }
+
+        char PieceTypeToLetter(EType type) {
+            switch (type) {
+                case EType::KNIGHT: return 'N';
+                case EType::BISHOP: return 'B';
+                case EType::ROOK: return 'R';
+                case EType::QUEEN: return 'Q';
+                case EType::KING: return 'K';
+                default: return ' ';
+            }
+        }
+
+        bool IsSpace(char c) {
+            return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+        }
+
+        bool IsResult(std::string_view token) {
+            return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+        }
+
+        // Index just past the bracketed block opened at 'position', honouring nesting.
+        std::size_t SkipBlock(std::string_view text, std::size_t position, char open, char close) {
+            int depth = 0;
+            for (; position < text.size(); ++position) {
+                const char c = text[position];
+                if (c == open) {
+                    ++depth;
+                } else if (c == close && --depth == 0) {
+                    return position + 1;
+                } else if (c == '{' && open != '{') {
+                    position = SkipBlock(text, position, '{', '}') - 1;
+                }
+            }
+            return text.size();
+        }
+
+        std::size_t SkipLine(std::string_view text, std::size_t position) {
+            const std::size_t end = text.find('\n', position);
+            return end == std::string_view::npos ? text.size() : end + 1;
+        }
+
+        class TGameReplay {
+            private:
+                TPgnStats& Stats;
+                const TPgnMoveVisitor& Visitor;
+                TBoard Board;
+                bool InGame;
+                bool HasMoves;
+                bool Failed;
+            public:
+                TGameReplay(TPgnStats& stats, const TPgnMoveVisitor& visitor)
+                    : Stats(stats)
+                    , Visitor(visitor)
+                    , InGame(false)
+                    , HasMoves(false)
+                    , Failed(false)
+                {
+                }
+                void Start() {
+                    Board.Clear();
+                    LoadStartBoard(Board);
+                    InGame = true;
+                    HasMoves = false;
+                    Failed = false;
+                }
+                void Finish() {
+                    if (!InGame) {
+                        return;
+                    }
+                    ++Stats.Games;
+                    Stats.CapturedWhite += Board.GetCapturedWhite();
+                    Stats.CapturedBlack += Board.GetCapturedBlack();
+                    InGame = false;
+                }
+                void Tag(std::string_view name, std::string_view value) {
+                    if (InGame && HasMoves) {
+                        Finish();
+                    }
+                    if (!InGame) {
+                        Start();
+                    }
+                    if (name == "FEN" && !LoadFen(Board, value)) {
+                        ++Stats.Errors;
+                        Failed = true;
+                    }
+                }
+                void Move(std::string_view san) {
+                    if (!InGame) {
+                        Start();
+                    }
+                    HasMoves = true;
+                    if (Failed) {
+                        return;
+                    }
+                    TMove move;
+                    bool illegal = false;
+                    if (!ParseSan(Board, san, move, illegal)) {
+                        ++(illegal ? Stats.IllegalMoves : Stats.Errors);
+                        Failed = true;
+                        return;
+                    }
+                    if (Visitor) {
+                        Visitor(Board, move);
+                    }
+                    Board.MovePiece(move);
+                    ++Stats.Moves;
+                }
+        };
+    }
+
+    void TPgnStats::Merge(const TPgnStats& other) {
+        Games += other.Games;
+        Moves += other.Moves;
+        IllegalMoves += other.IllegalMoves;
+        Errors += other.Errors;
+        CapturedWhite += other.CapturedWhite;
+        CapturedBlack += other.CapturedBlack;
+    }
+
+    bool ParseSan(const TPosition& board, std::string_view san, TMove& move, bool& illegal) {
+        illegal = false;
+        while (!san.empty() && (san.back() == '+' || san.back() == '#' || san.back() == '!' || san.back() == '?')) {
+            san.remove_suffix(1);
+        }
+        const EColor color = board.GetSideToMove();
+        const TSquare kingSquare = color == EColor::WHITE ? 4 : 60;
+
+        EType type = EType::PAWN;
+        EType promotion = EType::EMPTY;
+        TSquare to = NoSquare;
+        int fromFile = -1;
+        int fromRank = -1;
+        bool capture = false;
+        if (san == "O-O" || san == "0-0") {
+            type = EType::KING;
+            fromFile = kingSquare % 8;
+            fromRank = kingSquare / 8;
+            to = kingSquare + 2;
+        } else if (san == "O-O-O" || san == "0-0-0") {
+            type = EType::KING;
+            fromFile = kingSquare % 8;
+            fromRank = kingSquare / 8;
+            to = kingSquare - 2;
+        } else {
+            if (!san.empty() && PieceLetterToType(san.front()) != EType::EMPTY) {
+                type = PieceLetterToType(san.front());
+                san.remove_prefix(1);
+            }
+            if (type == EType::PAWN && san.size() >= 3) {
+                const char last = san.back();
+                const char beforeLast = san[san.size() - 2];
+                if (PieceLetterToType(last) != EType::EMPTY && (beforeLast == '=' || (beforeLast >= '1' && beforeLast <= '8'))) {
+                    promotion = PieceLetterToType(last);
+                    san.remove_suffix(beforeLast == '=' ? 2 : 1);
+                }
+            }
+            if (san.size() < 2) {
+                return false;
+            }
+            const char toFile = san[san.size() - 2];
+            const char toRank = san[san.size() - 1];
+            if (toFile < 'a' || toFile > 'h' || toRank < '1' || toRank > '8') {
+                return false;
+            }
+            to = (toRank - '1') * 8 + (toFile - 'a');
+            san.remove_suffix(2);
+            for (char c : san) {
+                if (c >= 'a' && c <= 'h') {
+                    fromFile = c - 'a';
+                } else if (c >= '1' && c <= '8') {
+                    fromRank = c - '1';
+                } else if (c == 'x' || c == ':') {
+                    capture = true;
+                } else {
+                    return false;
+                }
+            }
+            if (promotion == EType::KING || promotion == EType::PAWN) {
+                return false;
+            }
+        }
+
+        illegal = true;
+        const int lastRank = color == EColor::WHITE ? 7 : 0;
+        if (type == EType::PAWN && (to / 8 == lastRank) != (promotion != EType::EMPTY)) {
+            return false;
+        }
+        const TLegalityMasks masks = ComputeLegalityMasks(board, color);
+        TBitboard candidates = board.GetPieces(color, type);
+        int matches = 0;
+        while (candidates) {
+            const TSquare from = PopLowestSquare(candidates);
+            if ((fromFile >= 0 && from % 8 != fromFile) || (fromRank >= 0 && from / 8 != fromRank)) {
+                continue;
+            }
+            if (LegalTargets(board, masks, from) & SquareBit(to)) {
+                move = board.CreateMove(from, to, promotion);
+                ++matches;
+            }
+        }
+        if (matches != 1 || move.IsCapture() != capture) {
+            return false;
+        }
+        illegal = false;
+        return true;
+    }
+
+    std::string MoveToSan(const TPosition& board, TMove move) {
+        const TSquare from = move.GetFrom();
+        const TSquare to = move.GetTo();
+        const EType type = board.GetPiece(from)->Type;
+        std::string san;
+        if (move.GetFlag() == EMoveFlag::CASTLING) {
+            san = to > from ? "O-O" : "O-O-O";
+        } else {
+            if (type == EType::PAWN) {
+                if (move.IsCapture()) {
+                    san += static_cast<char>('a' + from % 8);
+                }
+            } else {
+                san += PieceTypeToLetter(type);
+                TMoveList moves;
+                GenerateMoves(board, board.GetSideToMove(), moves);
+                bool ambiguous = false;
+                bool sameFile = false;
+                bool sameRank = false;
+                for (const TMove& other : moves) {
+                    const TSquare otherFrom = other.GetFrom();
+                    if (other.GetTo() != to || otherFrom == from || board.GetPiece(otherFrom)->Type != type) {
+                        continue;
+                    }
+                    ambiguous = true;
+                    sameFile |= otherFrom % 8 == from % 8;
+                    sameRank |= otherFrom / 8 == from / 8;
+                }
+                if (ambiguous && (!sameFile || sameRank)) {
+                    san += static_cast<char>('a' + from % 8);
+                }
+                if (ambiguous && sameFile) {
+                    san += static_cast<char>('1' + from / 8);
+                }
+            }
+            if (move.IsCapture()) {
+                san += 'x';
+            }
+            san += static_cast<char>('a' + to % 8);
+            san += static_cast<char>('1' + to / 8);
+            if (move.GetPromotion() != EType::EMPTY) {
+                san += '=';
+                san += PieceTypeToLetter(move.GetPromotion());
+            }
+        }
+
+        TPosition next = board;
+        TUndo undo;
+        next.MakeMove(move, undo);
+        const EColor opponent = next.GetSideToMove();
+        if (InCheck(next, opponent)) {
+            TMoveList replies;
+            GenerateMoves(next, opponent, replies);
+            san += replies.Size == 0 ? '#' : '+';
+        }
+        return san;
+    }
+
+    TPgnStats ValidatePgn(std::string_view text) {
+        return ReplayPgn(text, {});
+    }
+
+    TPgnStats ReplayPgn(std::string_view text, const TPgnMoveVisitor& visitor) {
+        TPgnStats stats;
+        TGameReplay replay(stats, visitor);
+        std::size_t position = 0;
+        while (position < text.size()) {
+            const char c = text[position];
+            if (IsSpace(c)) {
+                ++position;
+            } else if (c == '[') {
+                const std::size_t end = SkipLine(text, position);
+                std::string_view tag = text.substr(position + 1, end - position - 1);
+                const std::size_t nameEnd = tag.find(' ');
+                const std::size_t valueStart = tag.find('"');
+                const std::size_t valueEnd = tag.rfind('"');
+                if (nameEnd != std::string_view::npos && valueStart != std::string_view::npos && valueEnd > valueStart) {
+                    replay.Tag(tag.substr(0, nameEnd), tag.substr(valueStart + 1, valueEnd - valueStart - 1));
+                } else {
+                    replay.Tag({}, {});
+                }
+                position = end;
+            } else if (c == '{') {
+                position = SkipBlock(text, position, '{', '}');
+            } else if (c == '(') {
+                position = SkipBlock(text, position, '(', ')');
+            } else if (c == ';' || c == '%') {
+                position = SkipLine(text, position);
+            } else {
+                std::size_t end = position;
+                while (end < text.size() && !IsSpace(text[end]) && text[end] != '{' && text[end] != '('
+                        && text[end] != ';' && text[end] != '[') {
+                    ++end;
+                }
+                std::string_view token = text.substr(position, end - position);
+                position = end;
+                if (IsResult(token)) {
+                    replay.Finish();
+                    continue;
+                }
+                if (token.front() == '$') {
+                    continue;
+                }
+                // Move numbers such as "12." or "12..." may be glued to the move.
+                std::size_t skip = 0;
+                while (skip < token.size() && token[skip] >= '0' && token[skip] <= '9') {
+                    ++skip;
+                }
+                if (skip > 0 && skip < token.size() && token[skip] == '.') {
+                    while (skip < token.size() && token[skip] == '.') {
+                        ++skip;
+                    }
+                    token.remove_prefix(skip);
+                }
+                if (!token.empty()) {
+                    replay.Move(token);
+                }
+            }
+        }
+        replay.Finish();
+        return stats;
+    }
+
+    std::vector<std::string_view> SplitPgn(std::string_view text, std::size_t shardBytes) {
+        std::vector<std::string_view> shards;
+        std::size_t start = 0;
+        while (start < text.size()) {
+            std::size_t cut = text.size();
+            std::size_t position = start + std::max<std::size_t>(shardBytes, 1);
+            while (position < text.size()) {
+                const std::size_t tag = text.find("\n[", position);
+                if (tag == std::string_view::npos) {
+                    break;
+                }
+                std::size_t previous = tag;
+                while (previous > start && text[previous - 1] == '\r') {
+                    --previous;
+                }
+                if (previous > start && text[previous - 1] == '\n') {
+                    cut = tag + 1;
+                    break;
+                }
+                position = tag + 1;
+            }
+            shards.push_back(text.substr(start, cut - start));
+            start = cut;
+        }
+        return shards;
+    }
+
+    TPgnStats ValidatePgnParallel(std::string_view text, int threads) {
+        constexpr std::size_t MinShardBytes = 64 * 1024;
+        const std::size_t workers = static_cast<std::size_t>(std::max(1, threads));
+        const std::vector<std::string_view> shards = SplitPgn(text, std::max(MinShardBytes, text.size() / (workers * 16)));
+
+        std::vector<TPgnStats> results(shards.size());
+        {
+            TThreadPool pool(threads);
+            for (std::size_t i = 0; i < shards.size(); ++i) {
+                pool.Submit([&shards, &results, i]() {
+                    results[i] = ValidatePgn(shards[i]);
+                });
+            }
+            pool.Wait();
+        }
+
+        TPgnStats stats;
+        for (const TPgnStats& result : results) {
+            stats.Merge(result);
+        }
+        return stats;
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "chess_board.h"
+
+namespace NChess {
+
+    struct TPgnStats {
+        std::uint64_t Games = 0;
+        std::uint64_t Moves = 0;
+        std::uint64_t IllegalMoves = 0;    // well-formed SAN the rules reject
+        std::uint64_t Errors = 0;          // unparsable SAN, bad FEN tags, overlong games
+        std::uint64_t CapturedWhite = 0;
+        std::uint64_t CapturedBlack = 0;
+
+        void Merge(const TPgnStats& other);
+    };
+
+    // Resolves a SAN move ("Nbd7", "exd5", "e8=Q+", "O-O") for the side to
+    // move. Returns false if the text is not SAN, no unique piece has it
+    // among its legal targets (the PieceCanMove rules), or an "x" marks a
+    // move that captures nothing (or its absence one that does); 'illegal'
+    // tells the two apart.
+    bool ParseSan(const TPosition& board, std::string_view san, TMove& move, bool& illegal);
+
+    // SAN of a legal move of the side to move, with the minimal file/rank
+    // disambiguation and a "+" or "#" suffix.
+    std::string MoveToSan(const TPosition& board, TMove move);
+
+    // Replays every game of a PGN database. A game stops at its first illegal
+    // or unparsable move and the rest of its movetext is skipped.
+    TPgnStats ValidatePgn(std::string_view text);
+
+    // Called with the position before each replayed move and the move itself.
+    using TPgnMoveVisitor = std::function<void(const TBoard& board, TMove move)>;
+
+    // ValidatePgn that also reports every accepted move to 'visitor'.
+    TPgnStats ReplayPgn(std::string_view text, const TPgnMoveVisitor& visitor);
+
+    // Cuts a database into shards of roughly 'shardBytes', each ending just
+    // before a tag section that follows a blank line, so no game is split.
+    std::vector<std::string_view> SplitPgn(std::string_view text, std::size_t shardBytes);
+
+    // Validates the shards on a work-stealing pool. Statistics are merged in
+    // shard order, so the totals do not depend on scheduling.
+    TPgnStats ValidatePgnParallel(std::string_view text, int threads);
+}
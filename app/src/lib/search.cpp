@@ -0,0 +1,312 @@
+#include "search.h"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace NChess {
+
+    namespace {
+        constexpr std::array<int, 7> PieceValues {0, 100, 330, 320, 500, 900, 0};
+
+        int PieceValue(const TChessPiece* piece) {
+            return PieceValues[static_cast<int>(piece->Type)];
+        }
+
+        bool SameMove(TMove lhs, TMove rhs) {
+            return lhs.Compact() == rhs.Compact();
+        }
+
+        bool IsHashMove(TMove move, const TTableEntry* hashEntry) {
+            return hashEntry != nullptr && move.Compact() == hashEntry->Move;
+        }
+
+        // Mate scores are stored relative to the node rather than to the root.
+        int ScoreToTable(int score, int ply) {
+            if (score >= MateScore - MaxSearchDepth) {
+                return score + ply;
+            }
+            if (score <= -MateScore + MaxSearchDepth) {
+                return score - ply;
+            }
+            return score;
+        }
+
+        int ScoreFromTable(int score, int ply) {
+            if (score >= MateScore - MaxSearchDepth) {
+                return score - ply;
+            }
+            if (score <= -MateScore + MaxSearchDepth) {
+                return score + ply;
+            }
+            return score;
+        }
+    }
+
+    TSearch::TSearch(const TBoard& board, TTranspositionTable& table)
+        : Board(board)
+        , Keys{}
+        , KeysNumber(0)
+        , Table(table)
+        , StopFlag(nullptr)
+        , ThreadIndex(0)
+        , Nodes(0)
+        , Stopped(false)
+        , RootBestMove{}
+        , Killers{}
+    {
+        const int length = board.GetHistoryLength();
+        const int kept = std::min({length, board.GetHalfmoveClock(), GameHistoryReserve});
+        for (int i = length - kept; i < length; ++i) {
+            Keys[KeysNumber++] = board.GetHistory(i).Hash;
+        }
+    }
+
+    bool TSearch::CheckLimits() {
+        if (StopFlag != nullptr && StopFlag->load(std::memory_order_relaxed)) {
+            Stopped = true;
+        } else if (Limits.MaxNodes != 0 && Nodes >= Limits.MaxNodes) {
+            Stopped = true;
+        } else if (Limits.MoveTime.count() != 0 && (Nodes & 1023) == 0
+                && std::chrono::steady_clock::now() - StartTime >= Limits.MoveTime) {
+            Stopped = true;
+        }
+        return Stopped;
+    }
+
+    // Fifty-move rule, or the position already occurred since the last
+    // capture or pawn move: a single repetition is scored as the draw it can
+    // be forced into.
+    bool TSearch::IsDraw() const {
+        if (Board.GetHalfmoveClock() >= 100) {
+            return true;
+        }
+        const int reversible = std::min(Board.GetHalfmoveClock(), KeysNumber);
+        for (int back = 4; back <= reversible; back += 2) {
+            if (Keys[KeysNumber - back] == Board.GetHash()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Previous iteration's best move first, then the hash move, captures by
+    // MVV-LVA and killer moves.
+    void TSearch::OrderMoves(TMoveList& moves, int ply, const TTableEntry* hashEntry) const {
+        std::array<int, MaxMovesNumber> scores;
+        for (int i = 0; i < moves.Size; ++i) {
+            const TMove& move = moves.Moves[i];
+            if (ply == 0 && SameMove(move, RootBestMove)) {
+                scores[i] = 1000000;
+            } else if (IsHashMove(move, hashEntry)) {
+                scores[i] = 500000;
+            } else if (move.IsCapture()) {
+                scores[i] = 100000 + PieceValue(move.GetCaptured()) * 10
+                    - PieceValue(Board.GetPiece(move.GetFrom())) / 10;
+            } else if (SameMove(move, Killers[ply][0])) {
+                scores[i] = 90000;
+            } else if (SameMove(move, Killers[ply][1])) {
+                scores[i] = 80000;
+            } else {
+                scores[i] = 0;
+            }
+        }
+        for (int i = 1; i < moves.Size; ++i) {
+            const TMove move = moves.Moves[i];
+            const int score = scores[i];
+            int j = i - 1;
+            for (; j >= 0 && scores[j] < score; --j) {
+                moves.Moves[j + 1] = moves.Moves[j];
+                scores[j + 1] = scores[j];
+            }
+            moves.Moves[j + 1] = move;
+            scores[j + 1] = score;
+        }
+    }
+
+    int TSearch::Quiescence(EColor color, int alpha, int beta, int ply) {
+        ++Nodes;
+        if (CheckLimits()) {
+            return 0;
+        }
+        const int standPat = Evaluate(Board, color);
+        if (standPat >= beta || ply >= MaxSearchDepth) {
+            return standPat;
+        }
+        alpha = std::max(alpha, standPat);
+
+        TMoveList moves;
+        GenerateMoves(Board, color, moves);
+        TMoveList captures;
+        for (const TMove& move : moves) {
+            if (move.IsCapture()) {
+                captures.Add(move);
+            }
+        }
+        OrderMoves(captures, ply, nullptr);
+        for (const TMove& move : captures) {
+            TUndo undo;
+            Board.MakeMove(move, undo);
+            const int score = -Quiescence(Opponent(color), -beta, -alpha, ply + 1);
+            Board.UnmakeMove(undo);
+            if (Stopped) {
+                return 0;
+            }
+            if (score >= beta) {
+                return score;
+            }
+            alpha = std::max(alpha, score);
+        }
+        return alpha;
+    }
+
+    int TSearch::Negamax(EColor color, int depth, int alpha, int beta, int ply) {
+        if (depth <= 0) {
+            return Quiescence(color, alpha, beta, ply);
+        }
+        ++Nodes;
+        if (CheckLimits()) {
+            return 0;
+        }
+        if (ply > 0 && IsDraw()) {
+            return 0;
+        }
+
+        TTableEntry hashEntry;
+        const bool hashHit = Table.Probe(Board.GetHash(), hashEntry);
+        if (hashHit && ply > 0 && hashEntry.Depth >= depth) {
+            const int score = ScoreFromTable(hashEntry.Score, ply);
+            if (hashEntry.Bound == EBound::EXACT
+                    || (hashEntry.Bound == EBound::LOWER && score >= beta)
+                    || (hashEntry.Bound == EBound::UPPER && score <= alpha)) {
+                return score;
+            }
+        }
+
+        TMoveList moves;
+        GenerateMoves(Board, color, moves);
+        if (moves.Size == 0) {
+            return InCheck(Board, color) ? -MateScore + ply : 0;
+        }
+        OrderMoves(moves, ply, hashHit ? &hashEntry : nullptr);
+
+        const int originalAlpha = alpha;
+        const TMove* bestMove = &moves.Moves[0];
+        int bestScore = -InfinityScore;
+        for (const TMove& move : moves) {
+            TUndo undo;
+            Keys[KeysNumber++] = Board.GetHash();
+            Board.MakeMove(move, undo);
+            const int score = -Negamax(Opponent(color), depth - 1, -beta, -alpha, ply + 1);
+            Board.UnmakeMove(undo);
+            --KeysNumber;
+            if (Stopped) {
+                return 0;
+            }
+            if (score > bestScore) {
+                bestScore = score;
+                bestMove = &move;
+                if (ply == 0) {
+                    RootBestMove = move;
+                }
+            }
+            if (score > alpha) {
+                alpha = score;
+            }
+            if (alpha >= beta) {
+                if (!move.IsCapture() && !SameMove(move, Killers[ply][0])) {
+                    Killers[ply][1] = Killers[ply][0];
+                    Killers[ply][0] = move;
+                }
+                break;
+            }
+        }
+
+        const EBound bound = bestScore >= beta ? EBound::LOWER
+            : bestScore > originalAlpha ? EBound::EXACT : EBound::UPPER;
+        Table.Store(Board.GetHash(), depth, ScoreToTable(bestScore, ply), bound, bestMove->Compact());
+        return bestScore;
+    }
+
+    TSearchResult TSearch::Search(const TSearchLimits& limits) {
+        const EColor color = Board.GetSideToMove();
+        Limits = limits;
+        StartTime = std::chrono::steady_clock::now();
+        Nodes = 0;
+        Stopped = false;
+        Killers = {};
+
+        TSearchResult result;
+        TMoveList rootMoves;
+        GenerateMoves(Board, color, rootMoves);
+        if (rootMoves.Size == 0) {
+            return result;
+        }
+        result.HasMove = true;
+        result.BestMove = rootMoves.Moves[0];
+        RootBestMove = rootMoves.Moves[0];
+
+        const int maxDepth = std::min(Limits.MaxDepth, MaxSearchDepth);
+        for (int depth = 1 + ThreadIndex % 2; depth <= maxDepth; ++depth) {
+            const int score = Negamax(color, depth, -InfinityScore, InfinityScore, 0);
+            if (Stopped) {
+                break;
+            }
+            result.BestMove = RootBestMove;
+            result.Score = score;
+            result.Depth = depth;
+            if (score >= MateScore - MaxSearchDepth || score <= -MateScore + MaxSearchDepth) {
+                break;
+            }
+        }
+        result.Nodes = Nodes;
+        result.Time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - StartTime);
+        return result;
+    }
+
+    TSearchResult ParallelSearch(const TBoard& board, TTranspositionTable& table, const TSearchLimits& limits,
+        std::atomic<bool>* stop) {
+        const int threads = std::max(1, limits.Threads);
+        table.NewSearch();
+
+        std::atomic<bool> localStop(false);
+        if (stop == nullptr) {
+            stop = &localStop;
+        }
+        std::vector<TSearch> searches;
+        searches.reserve(threads);
+        for (int i = 0; i < threads; ++i) {
+            searches.emplace_back(board, table);
+            searches.back().SetThread(i, stop);
+        }
+        std::vector<TSearchResult> results(threads);
+
+        TSearchLimits helperLimits = limits;
+        helperLimits.MoveTime = std::chrono::milliseconds(0);
+        helperLimits.MaxNodes = 0;
+        std::vector<std::thread> helpers;
+        for (int i = 1; i < threads; ++i) {
+            helpers.emplace_back([&, i]() {
+                results[i] = searches[i].Search(helperLimits);
+            });
+        }
+
+        results[0] = searches[0].Search(limits);
+        *stop = true;
+        for (std::thread& helper : helpers) {
+            helper.join();
+        }
+
+        TSearchResult result = results[0];
+        for (int i = 1; i < threads; ++i) {
+            if (results[i].HasMove && results[i].Depth > result.Depth) {
+                result.BestMove = results[i].BestMove;
+                result.Score = results[i].Score;
+                result.Depth = results[i].Depth;
+            }
+            result.Nodes += results[i].Nodes;
+        }
+        return result;
+    }
+}
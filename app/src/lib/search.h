@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "chess_board.h"
+#include "evaluation.h"
+#include "move_generator.h"
+#include "transposition_table.h"
+
+namespace NChess {
+
+    constexpr int MaxSearchDepth = 64;
+    constexpr int InfinityScore = 32001;
+    constexpr int MateScore = 32000;
+    // Positions a search line can add to its repetition keys: no line goes
+    // deeper than MaxSearchDepth plies, quiescence included.
+    constexpr int SearchHistoryReserve = MaxSearchDepth + 1;
+    // Game positions that can still repeat: the fifty-move rule draws after
+    // 100 reversible plies.
+    constexpr int GameHistoryReserve = 100;
+
+    struct TSearchLimits {
+        int MaxDepth = MaxSearchDepth;
+        std::chrono::milliseconds MoveTime{1000};   // zero means no time limit
+        std::uint64_t MaxNodes = 0;                  // zero means no node limit
+        int Threads = 1;
+    };
+
+    struct TSearchResult {
+        bool HasMove = false;
+        TMove BestMove{};
+        int Score = 0;
+        int Depth = 0;
+        std::uint64_t Nodes = 0;
+        std::chrono::milliseconds Time{0};
+    };
+
+    class TSearch {
+        private:
+            TPosition Board;
+            // Hashes of the positions before each move: the reversible end
+            // of the game, then the line being searched.
+            std::array<THash, GameHistoryReserve + SearchHistoryReserve> Keys;
+            int KeysNumber;
+            TTranspositionTable& Table;
+            TSearchLimits Limits;
+            const std::atomic<bool>* StopFlag;
+            int ThreadIndex;
+            std::chrono::steady_clock::time_point StartTime;
+            std::uint64_t Nodes;
+            bool Stopped;
+            TMove RootBestMove;
+            std::array<std::array<TMove, 2>, MaxSearchDepth + 1> Killers;
+            bool CheckLimits();
+            bool IsDraw() const;
+            void OrderMoves(TMoveList& moves, int ply, const TTableEntry* hashEntry) const;
+            int Quiescence(EColor color, int alpha, int beta, int ply);
+            int Negamax(EColor color, int depth, int alpha, int beta, int ply);
+        public:
+            // Searches a copy of the board's position; the game history only
+            // serves repetition detection.
+            TSearch(const TBoard& board, TTranspositionTable& table);
+            // Helper threads (index > 0) start at staggered depths and stop
+            // when the shared flag is raised.
+            void SetThread(int threadIndex, const std::atomic<bool>* stopFlag) {
+                ThreadIndex = threadIndex;
+                StopFlag = stopFlag;
+            }
+            TSearchResult Search(const TSearchLimits& limits);
+    };
+
+    // Lazy SMP: limits.Threads workers search copies of the board and share
+    // the transposition table; the first worker owns the time and node budget.
+    // A caller-owned 'stop' flag lets another thread end the search early; it
+    // is raised when the search returns and must be reset before reuse.
+    TSearchResult ParallelSearch(const TBoard& board, TTranspositionTable& table, const TSearchLimits& limits,
+        std::atomic<bool>* stop = nullptr);
+}
@@ -0,0 +1,287 @@
+#include "selfplay.h"
+#include "move_generator.h"
+#include "move_rules.h"
+#include "pgn.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <utility>
+
+namespace NChess {
+
+    namespace {
+        double EloToScore(double elo) {
+            return 1 / (1 + std::pow(10.0, -elo / 400));
+        }
+
+        double ScoreToElo(double score) {
+            score = std::clamp(score, 1e-6, 1 - 1e-6);
+            return 400 * std::log10(score / (1 - score));
+        }
+
+        // Variance of a single game's score around the match mean.
+        double ScoreVariance(const TMatchScore& score) {
+            const int games = score.GetGames();
+            if (games == 0) {
+                return 0;
+            }
+            const double mean = score.GetScore();
+            return (score.Wins * (1 - mean) * (1 - mean)
+                + score.Draws * (0.5 - mean) * (0.5 - mean)
+                + score.Losses * mean * mean) / games;
+        }
+
+        std::uint64_t MixSeed(std::uint64_t seed, std::uint64_t index) {
+            std::uint64_t z = seed + (index + 1) * 0x9e3779b97f4a7c15ULL;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        }
+
+        bool IsRepetition(const TBoard& board) {
+            const int length = board.GetHistoryLength();
+            const int reversible = std::min(board.GetHalfmoveClock(), length);
+            int seen = 1;
+            for (int back = 2; back <= reversible; back += 2) {
+                if (board.GetHistory(length - back).Hash == board.GetHash() && ++seen >= 3) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // No pawns or major pieces and at most one minor piece on the board.
+        bool IsInsufficientMaterial(const TBoard& board) {
+            TBitboard heavy = 0;
+            TBitboard minor = 0;
+            for (EColor color : {EColor::WHITE, EColor::BLACK}) {
+                heavy |= board.GetPieces(color, EType::PAWN) | board.GetPieces(color, EType::ROOK)
+                    | board.GetPieces(color, EType::QUEEN);
+                minor |= board.GetPieces(color, EType::BISHOP) | board.GetPieces(color, EType::KNIGHT);
+            }
+            return heavy == 0 && CountBits(minor) <= 1;
+        }
+
+        bool IsGameOver(const TBoard& board, int maxPlies, TSelfPlayGame& game) {
+            const EColor color = board.GetSideToMove();
+            TMoveList moves;
+            GenerateMoves(board, color, moves);
+            game.Result = EGameResult::DRAW;
+            if (moves.Size == 0) {
+                if (InCheck(board, color)) {
+                    game.Result = color == EColor::WHITE ? EGameResult::BLACK_WINS : EGameResult::WHITE_WINS;
+                    game.Termination = "checkmate";
+                } else {
+                    game.Termination = "stalemate";
+                }
+            } else if (board.GetHalfmoveClock() >= 100) {
+                game.Termination = "fifty-move rule";
+            } else if (IsRepetition(board)) {
+                game.Termination = "threefold repetition";
+            } else if (IsInsufficientMaterial(board)) {
+                game.Termination = "insufficient material";
+            } else if (static_cast<int>(game.Moves.size()) >= maxPlies) {
+                game.Termination = "adjudication: ply limit";
+            } else {
+                return false;
+            }
+            return true;
+        }
+
+        bool ChooseOpeningMove(const TBoard& board, const TOpeningBook* book, std::mt19937_64& random, TMove& move) {
+            if (book != nullptr && book->ChooseMove(board, random(), move)) {
+                return true;
+            }
+            TMoveList moves;
+            GenerateMoves(board, board.GetSideToMove(), moves);
+            if (moves.Size == 0) {
+                return false;
+            }
+            move = moves.Moves[random() % moves.Size];
+            return true;
+        }
+
+        TSelfPlayGame PlayGame(int round, const TEngineConfig& first, const TEngineConfig& second,
+            const TMatchOptions& options) {
+            TSelfPlayGame game;
+            game.Round = round;
+            game.FirstIsWhite = round % 2 == 0;
+            const TEngineConfig& white = game.FirstIsWhite ? first : second;
+            const TEngineConfig& black = game.FirstIsWhite ? second : first;
+            TTranspositionTable whiteTable(white.HashMb);
+            TTranspositionTable blackTable(black.HashMb);
+            std::mt19937_64 random(MixSeed(options.Seed, round / 2));
+
+            TBoard board;
+            LoadStartBoard(board);
+            while (!IsGameOver(board, options.MaxPlies, game)) {
+                const int ply = static_cast<int>(game.Moves.size());
+                TMove move{};
+                if (ply < options.OpeningPlies && ChooseOpeningMove(board, options.Book, random, move)) {
+                    game.OpeningPlies = ply + 1;
+                } else {
+                    const bool whiteToMove = board.GetSideToMove() == EColor::WHITE;
+                    TSearchLimits limits = (whiteToMove ? white : black).Limits;
+                    limits.Threads = 1;
+                    const TSearchResult result = ParallelSearch(board, whiteToMove ? whiteTable : blackTable, limits);
+                    game.Nodes += result.Nodes;
+                    move = result.BestMove;
+                }
+                game.Moves.push_back(MoveToSan(board, move));
+                board.MovePiece(move);
+            }
+            return game;
+        }
+    }
+
+    void TMatchScore::Add(const TSelfPlayGame& game) {
+        if (game.Result == EGameResult::DRAW) {
+            ++Draws;
+        } else if ((game.Result == EGameResult::WHITE_WINS) == game.FirstIsWhite) {
+            ++Wins;
+        } else {
+            ++Losses;
+        }
+    }
+
+    double TMatchScore::GetScore() const {
+        const int games = GetGames();
+        return games == 0 ? 0.5 : (Wins + 0.5 * Draws) / games;
+    }
+
+    double TMatchScore::GetElo() const {
+        return ScoreToElo(GetScore());
+    }
+
+    double TMatchScore::GetEloMargin() const {
+        const int games = GetGames();
+        if (games == 0) {
+            return 0;
+        }
+        const double error = 1.959964 * std::sqrt(ScoreVariance(*this) / games);
+        return (ScoreToElo(GetScore() + error) - ScoreToElo(GetScore() - error)) / 2;
+    }
+
+    double TMatchScore::GetLlr(double elo0, double elo1) const {
+        const double variance = ScoreVariance(*this);
+        if (variance == 0) {
+            return 0;
+        }
+        const double score0 = EloToScore(elo0);
+        const double score1 = EloToScore(elo1);
+        return GetGames() * (score1 - score0) * (2 * GetScore() - score0 - score1) / (2 * variance);
+    }
+
+    double TSprt::GetLowerBound() const {
+        return std::log(Beta / (1 - Alpha));
+    }
+
+    double TSprt::GetUpperBound() const {
+        return std::log((1 - Beta) / Alpha);
+    }
+
+    ESprtResult TSprt::Check(const TMatchScore& score) const {
+        if (!Enabled) {
+            return ESprtResult::NONE;
+        }
+        const double llr = score.GetLlr(Elo0, Elo1);
+        if (llr >= GetUpperBound()) {
+            return ESprtResult::ACCEPT_H1;
+        }
+        if (llr <= GetLowerBound()) {
+            return ESprtResult::ACCEPT_H0;
+        }
+        return ESprtResult::NONE;
+    }
+
+    TMatchResult PlayMatch(const TEngineConfig& first, const TEngineConfig& second, const TMatchOptions& options,
+        const TSelfPlayCallback& onGame) {
+        const auto start = std::chrono::steady_clock::now();
+        const std::size_t rounds = static_cast<std::size_t>(std::max(options.Games, 0));
+        TMatchResult match;
+        std::atomic<bool> decided(false);
+        std::mutex lock;
+        std::vector<std::unique_ptr<TSelfPlayGame>> finished(rounds);
+        std::size_t nextRound = 0;
+
+        {
+            TThreadPool pool(std::max(options.Concurrency, 1));
+            for (std::size_t round = 0; round < rounds; ++round) {
+                pool.Submit([&, round]() {
+                    if (decided.load(std::memory_order_relaxed)) {
+                        return;
+                    }
+                    auto game = std::make_unique<TSelfPlayGame>(PlayGame(static_cast<int>(round), first, second, options));
+                    std::lock_guard<std::mutex> guard(lock);
+                    finished[round] = std::move(game);
+                    while (!decided && nextRound < rounds && finished[nextRound]) {
+                        const TSelfPlayGame& next = *finished[nextRound];
+                        match.Score.Add(next);
+                        match.Nodes += next.Nodes;
+                        match.Sprt = options.Sprt.Check(match.Score);
+                        if (onGame) {
+                            onGame(next, match.Score);
+                        }
+                        finished[nextRound++].reset();
+                        if (match.Sprt != ESprtResult::NONE) {
+                            decided = true;
+                        }
+                    }
+                });
+            }
+            pool.Wait();
+        }
+        match.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return match;
+    }
+
+    const char* GameResultToString(EGameResult result) {
+        switch (result) {
+            case EGameResult::WHITE_WINS: return "1-0";
+            case EGameResult::BLACK_WINS: return "0-1";
+            default: return "1/2-1/2";
+        }
+    }
+
+    std::string FormatPgnGame(const TSelfPlayGame& game, const std::string& white, const std::string& black) {
+        const char* result = GameResultToString(game.Result);
+        std::ostringstream out;
+        out << "[Event \"Self-play\"]\n"
+            << "[Site \"?\"]\n"
+            << "[Date \"????.??.??\"]\n"
+            << "[Round \"" << game.Round + 1 << "\"]\n"
+            << "[White \"" << white << "\"]\n"
+            << "[Black \"" << black << "\"]\n"
+            << "[Result \"" << result << "\"]\n"
+            << "[PlyCount \"" << game.Moves.size() << "\"]\n"
+            << "[Termination \"" << game.Termination << "\"]\n\n";
+
+        std::string line;
+        const auto append = [&out, &line](const std::string& token) {
+            if (!line.empty() && line.size() + 1 + token.size() > 79) {
+                out << line << '\n';
+                line.clear();
+            }
+            line += line.empty() ? token : ' ' + token;
+        };
+        for (std::size_t ply = 0; ply < game.Moves.size(); ++ply) {
+            if (ply % 2 == 0) {
+                append(std::to_string(ply / 2 + 1) + ".");
+            }
+            append(game.Moves[ply]);
+            if (static_cast<int>(ply) + 1 == game.OpeningPlies) {
+                append("{end of opening}");
+            }
+        }
+        append(result);
+        out << line << "\n\n";
+        return out.str();
+    }
+}
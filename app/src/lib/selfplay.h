@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "opening_book.h"
+#include "search.h"
+#include "transposition_table.h"
+
+namespace NChess {
+
+    enum class EGameResult {
+        WHITE_WINS,
+        BLACK_WINS,
+        DRAW
+    };
+
+    struct TEngineConfig {
+        std::string Name;
+        TSearchLimits Limits;
+        std::size_t HashMb = TTranspositionTable::DefaultSizeMb;
+    };
+
+    struct TSelfPlayGame {
+        int Round = 0;
+        bool FirstIsWhite = true;       // the first configuration has white
+        int OpeningPlies = 0;           // leading moves not chosen by the engines
+        std::vector<std::string> Moves; // SAN
+        EGameResult Result = EGameResult::DRAW;
+        std::string Termination;
+        std::uint64_t Nodes = 0;
+    };
+
+    // Wins, draws and losses of the first configuration.
+    struct TMatchScore {
+        int Wins = 0;
+        int Draws = 0;
+        int Losses = 0;
+
+        void Add(const TSelfPlayGame& game);
+        int GetGames() const {
+            return Wins + Draws + Losses;
+        }
+        double GetScore() const;
+        // Logistic Elo difference and the half-width of its 95% interval.
+        double GetElo() const;
+        double GetEloMargin() const;
+        // Log-likelihood ratio of elo1 against elo0, normal approximation
+        // of the game score distribution.
+        double GetLlr(double elo0, double elo1) const;
+    };
+
+    enum class ESprtResult {
+        NONE,
+        ACCEPT_H0,
+        ACCEPT_H1
+    };
+
+    struct TSprt {
+        bool Enabled = false;
+        double Elo0 = 0;
+        double Elo1 = 5;
+        double Alpha = 0.05;
+        double Beta = 0.05;
+
+        double GetLowerBound() const;
+        double GetUpperBound() const;
+        ESprtResult Check(const TMatchScore& score) const;
+    };
+
+    struct TMatchOptions {
+        int Games = 100;
+        int Concurrency = 1;
+        int OpeningPlies = 8;           // book moves, else random legal moves
+        int MaxPlies = 400;             // adjudicated a draw beyond this
+        std::uint64_t Seed = 1;
+        const TOpeningBook* Book = nullptr;
+        TSprt Sprt;
+    };
+
+    struct TMatchResult {
+        TMatchScore Score;
+        ESprtResult Sprt = ESprtResult::NONE;
+        std::uint64_t Nodes = 0;
+        double Seconds = 0;
+    };
+
+    // Called in round order, one game at a time, with the score so far.
+    using TSelfPlayCallback = std::function<void(const TSelfPlayGame& game, const TMatchScore& score)>;
+
+    // Plays 'first' against 'second' on a pool of options.Concurrency workers.
+    // Rounds come in pairs sharing one opening with colors swapped, and every
+    // engine searches single-threaded with its own table, so with node or
+    // depth limits the games depend only on the seed. Games are scored in
+    // round order; once the SPRT decides, later rounds are neither started
+    // nor counted.
+    TMatchResult PlayMatch(const TEngineConfig& first, const TEngineConfig& second, const TMatchOptions& options,
+        const TSelfPlayCallback& onGame);
+
+    const char* GameResultToString(EGameResult result);
+
+    std::string FormatPgnGame(const TSelfPlayGame& game, const std::string& white, const std::string& black);
+}
@@ -0,0 +1,115 @@
+#include "stats.h"
+
+#include <algorithm>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace NChess {
+
+    namespace NStats {
+
+        namespace {
+            constexpr std::array<const char*, CountersNumber> CounterNames {
+                "PieceCanMove",
+                "LegalityMasks",
+                "LegalTargets",
+                "MovePiece",
+                "UndoMove",
+                "Render",
+            };
+
+            struct TTotals {
+                std::array<std::uint64_t, CountersNumber> Calls{};
+                std::array<std::uint64_t, CountersNumber> Nanoseconds{};
+                std::array<std::array<std::uint64_t, HistogramBuckets>, CountersNumber> Histogram{};
+
+                void Add(const TThreadCounters& counters) {
+                    for (int i = 0; i < CountersNumber; ++i) {
+                        Calls[i] += counters.Calls[i].load(std::memory_order_relaxed);
+                        Nanoseconds[i] += counters.Nanoseconds[i].load(std::memory_order_relaxed);
+                        for (int bucket = 0; bucket < HistogramBuckets; ++bucket) {
+                            Histogram[i][bucket] += counters.Histogram[i][bucket].load(std::memory_order_relaxed);
+                        }
+                    }
+                }
+            };
+
+            std::mutex RegistryLock;
+            std::vector<const TThreadCounters*> LiveCounters;
+            TTotals RetiredTotals;
+
+            // A thread's counters join the registry on first use and are
+            // folded into RetiredTotals when the thread exits.
+            struct TRegistration {
+                TThreadCounters Counters;
+
+                TRegistration() {
+                    std::lock_guard<std::mutex> guard(RegistryLock);
+                    LiveCounters.push_back(&Counters);
+                }
+                ~TRegistration() {
+                    std::lock_guard<std::mutex> guard(RegistryLock);
+                    RetiredTotals.Add(Counters);
+                    LiveCounters.erase(std::find(LiveCounters.begin(), LiveCounters.end(), &Counters));
+                }
+            };
+
+            void Increment(std::atomic<std::uint64_t>& value, std::uint64_t delta) {
+                value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+            }
+
+            int Bucket(std::uint64_t nanoseconds) {
+                int bucket = 0;
+                while (nanoseconds > 1 && bucket < HistogramBuckets - 1) {
+                    nanoseconds >>= 1;
+                    ++bucket;
+                }
+                return bucket;
+            }
+        }
+
+        TThreadCounters& ThreadCounters() {
+            thread_local TRegistration registration;
+            return registration.Counters;
+        }
+
+        void Record(ECounter counter, std::uint64_t nanoseconds) {
+            TThreadCounters& counters = ThreadCounters();
+            const int index = static_cast<int>(counter);
+            Increment(counters.Calls[index], 1);
+            Increment(counters.Nanoseconds[index], nanoseconds);
+            Increment(counters.Histogram[index][Bucket(nanoseconds)], 1);
+        }
+
+        std::string Report() {
+            if (!Enabled) {
+                return "stats: disabled, configure with -DCLCHESS_STATS=ON\n";
+            }
+            TTotals totals;
+            {
+                std::lock_guard<std::mutex> guard(RegistryLock);
+                totals = RetiredTotals;
+                for (const TThreadCounters* counters : LiveCounters) {
+                    totals.Add(*counters);
+                }
+            }
+
+            std::ostringstream out;
+            for (int i = 0; i < CountersNumber; ++i) {
+                const std::uint64_t calls = totals.Calls[i];
+                out << "stats: " << CounterNames[i]
+                    << " calls " << calls
+                    << " ns_per_call " << (calls > 0 ? totals.Nanoseconds[i] / calls : 0)
+                    << " histogram";
+                for (int bucket = 0; bucket < HistogramBuckets; ++bucket) {
+                    if (totals.Histogram[i][bucket] != 0) {
+                        out << " <" << (std::uint64_t(2) << bucket) << "ns:" << totals.Histogram[i][bucket];
+                    }
+                }
+                out << '\n';
+            }
+            return out.str();
+        }
+    }
+}
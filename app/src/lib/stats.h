@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace NChess {
+
+    // Call counters and scoped timers for hot paths. They are compiled in only
+    // with CLCHESS_STATS; otherwise CLCHESS_STATS_SCOPE expands to nothing.
+    namespace NStats {
+
+#if defined(CLCHESS_STATS)
+        constexpr bool Enabled = true;
+#else
+        constexpr bool Enabled = false;
+#endif
+
+        enum class ECounter {
+            PIECE_CAN_MOVE,
+            LEGALITY_MASKS,
+            LEGAL_TARGETS,
+            MOVE_PIECE,
+            UNDO_MOVE,
+            RENDER,
+            COUNT
+        };
+
+        constexpr int CountersNumber = static_cast<int>(ECounter::COUNT);
+        constexpr int HistogramBuckets = 32;    // bucket b holds durations in [2^b, 2^(b+1)) ns
+
+        // Every thread owns one block and is its only writer, so updates are
+        // plain relaxed load/store pairs; Report() reads the live blocks.
+        struct TThreadCounters {
+            std::array<std::atomic<std::uint64_t>, CountersNumber> Calls{};
+            std::array<std::atomic<std::uint64_t>, CountersNumber> Nanoseconds{};
+            std::array<std::array<std::atomic<std::uint64_t>, HistogramBuckets>, CountersNumber> Histogram{};
+        };
+
+        TThreadCounters& ThreadCounters();
+
+        void Record(ECounter counter, std::uint64_t nanoseconds);
+
+        // Totals over finished and running threads: calls, nanoseconds per
+        // call and the duration histogram of every counter.
+        std::string Report();
+
+        class TScopedTimer {
+            private:
+                ECounter Counter;
+                std::chrono::steady_clock::time_point Start;
+            public:
+                explicit TScopedTimer(ECounter counter)
+                    : Counter(counter)
+                    , Start(std::chrono::steady_clock::now())
+                {
+                }
+                TScopedTimer(const TScopedTimer&) = delete;
+                TScopedTimer& operator=(const TScopedTimer&) = delete;
+                ~TScopedTimer() {
+                    const auto elapsed = std::chrono::steady_clock::now() - Start;
+                    Record(Counter, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+                }
+        };
+    }
+}
+
+#if defined(CLCHESS_STATS)
+#define CLCHESS_STATS_SCOPE(counter) \
+    const ::NChess::NStats::TScopedTimer statsScope(::NChess::NStats::ECounter::counter)
+#else
+#define CLCHESS_STATS_SCOPE(counter) static_cast<void>(0)
+#endif
@@ -0,0 +1,102 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+namespace NChess {
+
+    TThreadPool::TThreadPool(int threads)
+        : Queued(0)
+        , Pending(0)
+        , NextQueue(0)
+        , Stopping(false)
+    {
+        const std::size_t count = static_cast<std::size_t>(std::max(1, threads));
+        for (std::size_t i = 0; i < count; ++i) {
+            Queues.emplace_back(std::make_unique<TWorkerQueue>());
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            Workers.emplace_back([this, i]() {
+                Run(i);
+            });
+        }
+    }
+
+    TThreadPool::~TThreadPool() {
+        {
+            std::lock_guard<std::mutex> guard(StateLock);
+            Stopping = true;
+        }
+        HasWork.notify_all();
+        for (std::thread& worker : Workers) {
+            worker.join();
+        }
+    }
+
+    // The task is queued and counted under StateLock so a worker can never
+    // see it dequeued before it was counted.
+    void TThreadPool::Submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> guard(StateLock);
+            TWorkerQueue& queue = *Queues[NextQueue++ % Queues.size()];
+            {
+                std::lock_guard<std::mutex> queueGuard(queue.Lock);
+                queue.Tasks.push_back(std::move(task));
+            }
+            ++Queued;
+            ++Pending;
+        }
+        HasWork.notify_one();
+    }
+
+    void TThreadPool::Wait() {
+        std::unique_lock<std::mutex> lock(StateLock);
+        AllDone.wait(lock, [this]() {
+            return Pending == 0;
+        });
+    }
+
+    bool TThreadPool::TryTake(std::size_t index, std::function<void()>& task) {
+        for (std::size_t offset = 0; offset < Queues.size(); ++offset) {
+            TWorkerQueue& queue = *Queues[(index + offset) % Queues.size()];
+            std::lock_guard<std::mutex> guard(queue.Lock);
+            if (queue.Tasks.empty()) {
+                continue;
+            }
+            if (offset == 0) {
+                task = std::move(queue.Tasks.back());
+                queue.Tasks.pop_back();
+            } else {
+                task = std::move(queue.Tasks.front());
+                queue.Tasks.pop_front();
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void TThreadPool::Run(std::size_t index) {
+        std::function<void()> task;
+        while (true) {
+            if (TryTake(index, task)) {
+                {
+                    std::lock_guard<std::mutex> guard(StateLock);
+                    --Queued;
+                }
+                task();
+                task = nullptr;
+                std::lock_guard<std::mutex> guard(StateLock);
+                if (--Pending == 0) {
+                    AllDone.notify_all();
+                }
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(StateLock);
+            HasWork.wait(lock, [this]() {
+                return Queued > 0 || Stopping;
+            });
+            if (Stopping && Queued == 0) {
+                return;
+            }
+        }
+    }
+}
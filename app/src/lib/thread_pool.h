@@ -0,0 +1,45 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace NChess {
+
+    // Fixed set of workers, each with its own task deque. A worker takes its
+    // newest task first and, when idle, steals the oldest task of another worker.
+    class TThreadPool {
+        private:
+            struct TWorkerQueue {
+                std::mutex Lock;
+                std::deque<std::function<void()>> Tasks;
+            };
+
+            std::vector<std::unique_ptr<TWorkerQueue>> Queues;
+            std::vector<std::thread> Workers;
+            std::mutex StateLock;
+            std::condition_variable HasWork;
+            std::condition_variable AllDone;
+            std::size_t Queued;
+            std::size_t Pending;
+            std::size_t NextQueue;
+            bool Stopping;
+            bool TryTake(std::size_t index, std::function<void()>& task);
+            void Run(std::size_t index);
+        public:
+            explicit TThreadPool(int threads);
+            TThreadPool(const TThreadPool&) = delete;
+            TThreadPool& operator=(const TThreadPool&) = delete;
+            ~TThreadPool();
+            void Submit(std::function<void()> task);
+            void Wait();
+            int GetThreadsNumber() const {
+                return static_cast<int>(Workers.size());
+            }
+    };
+}
@@ -0,0 +1,127 @@
+#include "transposition_table.h"
+
+#include <algorithm>
+
+namespace NChess {
+
+    namespace {
+        // Entry layout: move:16 | bound:2 | unused:6 | depth:8 | generation:8 | score:16 | unused:8
+        constexpr int BoundShift = 16;
+        constexpr int DepthShift = 24;
+        constexpr int GenerationShift = 32;
+        constexpr int ScoreShift = 40;
+
+        std::uint64_t Pack(int depth, int score, EBound bound, std::uint16_t move, std::uint8_t generation) {
+            return static_cast<std::uint64_t>(move)
+                | static_cast<std::uint64_t>(bound) << BoundShift
+                | static_cast<std::uint64_t>(std::clamp(depth, 0, 255)) << DepthShift
+                | static_cast<std::uint64_t>(generation) << GenerationShift
+                | static_cast<std::uint64_t>(static_cast<std::uint16_t>(score)) << ScoreShift;
+        }
+
+        EBound UnpackBound(std::uint64_t data) {
+            return static_cast<EBound>((data >> BoundShift) & 3);
+        }
+
+        int UnpackDepth(std::uint64_t data) {
+            return static_cast<int>((data >> DepthShift) & 0xFF);
+        }
+
+        std::uint8_t UnpackGeneration(std::uint64_t data) {
+            return static_cast<std::uint8_t>(data >> GenerationShift);
+        }
+    }
+
+    TTranspositionTable::TTranspositionTable(std::size_t sizeMb, std::size_t shares)
+        : BucketsNumber(0)
+        , Generation(0)
+    {
+        ResizeBytes(std::max<std::size_t>(sizeMb, 1) * BytesPerMb / std::max<std::size_t>(shares, 1));
+    }
+
+    void TTranspositionTable::Resize(std::size_t sizeMb) {
+        ResizeBytes(std::max<std::size_t>(sizeMb, 1) * BytesPerMb);
+    }
+
+    void TTranspositionTable::ResizeBytes(std::size_t sizeBytes) {
+        const std::size_t buckets = std::max<std::size_t>(sizeBytes / sizeof(TBucket), 1);
+        Buckets.reset();
+        Buckets = std::make_unique<TBucket[]>(buckets);
+        BucketsNumber = buckets;
+        Clear();
+    }
+
+    void TTranspositionTable::Clear() {
+        for (std::size_t i = 0; i < BucketsNumber; ++i) {
+            for (TSlot& slot : Buckets[i].Slots) {
+                slot.Check.store(0, std::memory_order_relaxed);
+                slot.Data.store(0, std::memory_order_relaxed);
+            }
+        }
+        Generation = 0;
+    }
+
+    void TTranspositionTable::NewSearch() {
+        ++Generation;
+    }
+
+    bool TTranspositionTable::Probe(THash hash, TTableEntry& entry) const {
+        for (const TSlot& slot : GetBucket(hash).Slots) {
+            const std::uint64_t data = slot.Data.load(std::memory_order_relaxed);
+            const std::uint64_t check = slot.Check.load(std::memory_order_relaxed);
+            if ((check ^ data) != hash || UnpackBound(data) == EBound::NONE) {
+                continue;
+            }
+            entry.Move = static_cast<std::uint16_t>(data);
+            entry.Bound = UnpackBound(data);
+            entry.Depth = UnpackDepth(data);
+            entry.Score = static_cast<std::int16_t>(data >> ScoreShift);
+            return true;
+        }
+        return false;
+    }
+
+    // Replace the entry for the same position if present, otherwise the
+    // shallowest entry, treating entries from older searches as shallower.
+    void TTranspositionTable::Store(THash hash, int depth, int score, EBound bound, std::uint16_t move) {
+        TBucket& bucket = GetBucket(hash);
+        TSlot* victim = nullptr;
+        int victimWorth = 0;
+        for (TSlot& slot : bucket.Slots) {
+            const std::uint64_t data = slot.Data.load(std::memory_order_relaxed);
+            const std::uint64_t check = slot.Check.load(std::memory_order_relaxed);
+            if ((check ^ data) == hash || data == 0) {
+                victim = &slot;
+                break;
+            }
+            const int age = static_cast<std::uint8_t>(Generation - UnpackGeneration(data));
+            const int worth = UnpackDepth(data) - 8 * age;
+            if (victim == nullptr || worth < victimWorth) {
+                victim = &slot;
+                victimWorth = worth;
+            }
+        }
+        const std::uint64_t data = Pack(depth, score, bound, move, Generation);
+        victim->Check.store(hash ^ data, std::memory_order_relaxed);
+        victim->Data.store(data, std::memory_order_relaxed);
+    }
+
+    std::size_t TTranspositionTable::GetSizeBytes() const {
+        return BucketsNumber * sizeof(TBucket);
+    }
+
+    // Permille of sampled slots written during the current search.
+    int TTranspositionTable::GetHashfull() const {
+        const std::size_t sample = std::min<std::size_t>(BucketsNumber, 250);
+        int used = 0;
+        for (std::size_t i = 0; i < sample; ++i) {
+            for (const TSlot& slot : Buckets[i].Slots) {
+                const std::uint64_t data = slot.Data.load(std::memory_order_relaxed);
+                if (UnpackBound(data) != EBound::NONE && UnpackGeneration(data) == Generation) {
+                    ++used;
+                }
+            }
+        }
+        return static_cast<int>(used * 1000 / (sample * BucketSize));
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "chess_board.h"
+#include "zobrist.h"
+
+namespace NChess {
+
+    enum class EBound : std::uint8_t {
+        NONE,
+        UPPER,
+        LOWER,
+        EXACT
+    };
+
+    struct TTableEntry {
+        int Depth = 0;
+        int Score = 0;
+        EBound Bound = EBound::NONE;
+        std::uint16_t Move = 0;   // TMove::Compact() of the best move
+    };
+
+    // Fixed-size table shared by search threads without locks. Every slot keeps
+    // the packed entry next to (hash ^ entry), so a slot torn by a concurrent
+    // writer fails verification on probe and reads as a miss.
+    class TTranspositionTable {
+        private:
+            struct TSlot {
+                std::atomic<std::uint64_t> Check;
+                std::atomic<std::uint64_t> Data;
+            };
+            static constexpr int BucketSize = 4;
+            struct alignas(64) TBucket {
+                std::array<TSlot, BucketSize> Slots;
+            };
+
+            std::unique_ptr<TBucket[]> Buckets;
+            std::size_t BucketsNumber;
+            std::uint8_t Generation;
+            // High half of hash * BucketsNumber: spreads the hash over any
+            // bucket count, not only powers of two.
+            TBucket& GetBucket(THash hash) const {
+                __extension__ typedef unsigned __int128 TProduct;
+                return Buckets[static_cast<std::size_t>((static_cast<TProduct>(hash) * BucketsNumber) >> 64)];
+            }
+        public:
+            static constexpr std::size_t DefaultSizeMb = 16;
+            static constexpr std::size_t BytesPerMb = 1024 * 1024;
+
+            // One of 'shares' equal parts of sizeMb, for tables that split a
+            // common budget.
+            explicit TTranspositionTable(std::size_t sizeMb = DefaultSizeMb, std::size_t shares = 1);
+            void Resize(std::size_t sizeMb);
+            // Uses sizeBytes rounded down to whole 64-byte buckets, at least one.
+            void ResizeBytes(std::size_t sizeBytes);
+            void Clear();
+            void NewSearch();
+            bool Probe(THash hash, TTableEntry& entry) const;
+            void Store(THash hash, int depth, int score, EBound bound, std::uint16_t move);
+            std::size_t GetSizeBytes() const;
+            int GetHashfull() const;
+    };
+}
@@ -0,0 +1,228 @@
+#include "uci.h"
+#include "fen.h"
+#include "move_generator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+namespace NChess {
+
+    namespace {
+        char PromotionChar(EType type) {
+            switch (type) {
+                case EType::KNIGHT: return 'n';
+                case EType::BISHOP: return 'b';
+                case EType::ROOK: return 'r';
+                case EType::QUEEN: return 'q';
+                default: return '\0';
+            }
+        }
+
+        std::string ScoreToUci(int score) {
+            if (score >= MateScore - MaxSearchDepth) {
+                return "mate " + std::to_string((MateScore - score + 1) / 2);
+            }
+            if (score <= -MateScore + MaxSearchDepth) {
+                return "mate -" + std::to_string((MateScore + score) / 2);
+            }
+            return "cp " + std::to_string(score);
+        }
+    }
+
+    std::string MoveToUci(TMove move) {
+        if (move.IsNull()) {
+            return "0000";
+        }
+        std::string result;
+        result += static_cast<char>('a' + move.GetFrom() % 8);
+        result += static_cast<char>('1' + move.GetFrom() / 8);
+        result += static_cast<char>('a' + move.GetTo() % 8);
+        result += static_cast<char>('1' + move.GetTo() / 8);
+        const char promotion = PromotionChar(move.GetPromotion());
+        if (promotion != '\0') {
+            result += promotion;
+        }
+        return result;
+    }
+
+    bool ParseUciMove(const TPosition& board, std::string_view text, TMove& move) {
+        if (text.size() != 4 && text.size() != 5) {
+            return false;
+        }
+        TMoveList moves;
+        GenerateMoves(board, board.GetSideToMove(), moves);
+        for (const TMove& candidate : moves) {
+            if (MoveToUci(candidate) == text) {
+                move = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    TUci::~TUci() {
+        StopSearch();
+    }
+
+    void TUci::Send(const std::string& line) {
+        std::lock_guard<std::mutex> guard(OutputLock);
+        std::cout << line << '\n' << std::flush;
+    }
+
+    void TUci::StopSearch() {
+        if (SearchThread.joinable()) {
+            StopRequested = true;
+            StopFlag = true;
+            SearchThread.join();
+        }
+        StopRequested = false;
+        StopFlag = false;
+    }
+
+    void TUci::SetOption(std::istringstream& input) {
+        std::string token, name, value;
+        input >> token >> name >> token >> value;
+        if (name == "Hash") {
+            Table.Resize(std::max(1, std::atoi(value.c_str())));
+            Send("info string hash " + std::to_string(Table.GetSizeBytes()) + " bytes");
+        } else if (name == "Threads") {
+            EngineLimits.Threads = std::max(1, std::atoi(value.c_str()));
+        } else if (name == "OwnBook" && Book) {
+            OwnBook = value == "true";
+        } else {
+            Send("info string unknown option " + name);
+        }
+    }
+
+    void TUci::SetPosition(std::istringstream& input) {
+        std::string token;
+        input >> token;
+        bool loaded = false;
+        if (token == "startpos") {
+            loaded = LoadFen(Board, StartFen);
+            input >> token;
+        } else if (token == "fen") {
+            std::string fen;
+            while (input >> token && token != "moves") {
+                fen += fen.empty() ? token : " " + token;
+            }
+            loaded = LoadFen(Board, fen);
+        }
+        if (!loaded) {
+            LoadFen(Board, StartFen);
+            Send("info string invalid position");
+            return;
+        }
+        if (token != "moves") {
+            return;
+        }
+        while (input >> token) {
+            TMove move;
+            if (!ParseUciMove(Board, token, move)) {
+                Send("info string illegal move " + token);
+                return;
+            }
+            Board.MovePiece(move);
+        }
+    }
+
+    void TUci::Go(std::istringstream& input) {
+        TSearchLimits limits;
+        limits.MoveTime = std::chrono::milliseconds(0);
+        limits.Threads = EngineLimits.Threads;
+        const bool white = Board.GetSideToMove() == EColor::WHITE;
+        long long time = 0;
+        long long increment = 0;
+        int movesToGo = 30;
+        bool infinite = false;
+        std::string token;
+        while (input >> token) {
+            long long value = 0;
+            if (token != "infinite" && token != "ponder" && !(input >> value)) {
+                break;
+            }
+            if (token == "infinite") {
+                infinite = true;
+            } else if (token == "depth") {
+                limits.MaxDepth = static_cast<int>(std::clamp<long long>(value, 1, MaxSearchDepth));
+            } else if (token == "movetime") {
+                limits.MoveTime = std::chrono::milliseconds(std::max<long long>(value, 1));
+            } else if (token == "nodes") {
+                limits.MaxNodes = static_cast<std::uint64_t>(std::max<long long>(value, 1));
+            } else if (token == (white ? "wtime" : "btime")) {
+                time = value;
+            } else if (token == (white ? "winc" : "binc")) {
+                increment = value;
+            } else if (token == "movestogo") {
+                movesToGo = static_cast<int>(std::max<long long>(value, 1));
+            }
+        }
+        if (time > 0 && limits.MoveTime.count() == 0) {
+            const long long budget = time / movesToGo + increment / 2;
+            limits.MoveTime = std::chrono::milliseconds(std::clamp<long long>(budget, 1, std::max<long long>(time - 50, 1)));
+        }
+
+        TMove bookMove;
+        if (OwnBook && !infinite && Book->ChooseMove(Board, BookRandom(), bookMove)) {
+            Send("info string book move");
+            Send("bestmove " + MoveToUci(bookMove));
+            return;
+        }
+
+        SearchThread = std::thread([this, limits, infinite]() {
+            const TSearchResult result = ParallelSearch(Board, Table, limits, &StopFlag);
+            // "go infinite" must not report a move before "stop", even after a mate is found.
+            while (infinite && !StopRequested) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            const std::int64_t ms = result.Time.count();
+            Send("info depth " + std::to_string(result.Depth)
+                + " score " + ScoreToUci(result.Score)
+                + " nodes " + std::to_string(result.Nodes)
+                + " nps " + std::to_string(ms > 0 ? result.Nodes * 1000 / ms : result.Nodes)
+                + " time " + std::to_string(ms)
+                + " hashfull " + std::to_string(Table.GetHashfull())
+                + " pv " + MoveToUci(result.BestMove));
+            Send("bestmove " + MoveToUci(result.HasMove ? result.BestMove : TMove{}));
+        });
+    }
+
+    void TUci::Process() {
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            std::istringstream input(line);
+            std::string command;
+            input >> command;
+            if (command == "uci") {
+                Send("id name clchess");
+                Send("option name Hash type spin default " + std::to_string(TTranspositionTable::DefaultSizeMb) + " min 1 max 65536");
+                Send("option name Threads type spin default 1 min 1 max 256");
+                if (Book) {
+                    Send("option name OwnBook type check default true");
+                }
+                Send("uciok");
+            } else if (command == "isready") {
+                Send("readyok");
+            } else if (command == "ucinewgame") {
+                StopSearch();
+                Table.Clear();
+            } else if (command == "setoption") {
+                StopSearch();
+                SetOption(input);
+            } else if (command == "position") {
+                StopSearch();
+                SetPosition(input);
+            } else if (command == "go") {
+                StopSearch();
+                Go(input);
+            } else if (command == "stop") {
+                StopSearch();
+            } else if (command == "quit") {
+                break;
+            }
+        }
+        StopSearch();
+    }
+}
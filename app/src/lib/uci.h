@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "chess_board.h"
+#include "opening_book.h"
+#include "search.h"
+#include "transposition_table.h"
+
+namespace NChess {
+
+    // Long algebraic notation used by UCI: "e2e4", "e7e8q".
+    std::string MoveToUci(TMove move);
+
+    // Finds the legal move written as 'text' for the side to move.
+    bool ParseUciMove(const TPosition& board, std::string_view text, TMove& move);
+
+    // UCI front-end. Commands are read line by line from stdin while "go"
+    // runs on a background thread, so "stop" and "isready" are answered
+    // during a search.
+    class TUci {
+        private:
+            TBoard& Board;
+            TTranspositionTable& Table;
+            TSearchLimits EngineLimits;
+            const TOpeningBook* Book;
+            bool OwnBook;
+            std::mt19937_64 BookRandom;
+            std::atomic<bool> StopFlag;
+            std::atomic<bool> StopRequested;
+            std::thread SearchThread;
+            std::mutex OutputLock;
+            void Send(const std::string& line);
+            void StopSearch();
+            void SetOption(std::istringstream& input);
+            void SetPosition(std::istringstream& input);
+            void Go(std::istringstream& input);
+        public:
+            // With a book, "go" answers book positions without searching
+            // unless the OwnBook option is switched off.
+            TUci(TBoard& board, TTranspositionTable& table, const TSearchLimits& engineLimits, const TOpeningBook* book = nullptr)
+                : Board(board)
+                , Table(table)
+                , EngineLimits(engineLimits)
+                , Book(book)
+                , OwnBook(book != nullptr)
+                , BookRandom(std::random_device{}())
+                , StopFlag(false)
+                , StopRequested(false)
+            {
+                NChess::LoadStartBoard(Board);
+            }
+            ~TUci();
+            void Process();
+    };
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "chess_piece.h"
+
+namespace NChess {
+
+    using THash = std::uint64_t;
+
+    namespace NZobrist {
+        constexpr THash SplitMix(THash& state) {
+            THash z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        // Indexed by [EColor][EType][square]; entries for EMPTY stay zero.
+        using TPieceKeys = std::array<std::array<std::array<THash, 64>, 7>, 3>;
+
+        constexpr TPieceKeys MakePieceKeys() {
+            TPieceKeys keys{};
+            THash state = 0x636C63686573735AULL;
+            for (int color = 1; color < 3; ++color) {
+                for (int type = 1; type < 7; ++type) {
+                    for (int square = 0; square < 64; ++square) {
+                        keys[color][type][square] = SplitMix(state);
+                    }
+                }
+            }
+            return keys;
+        }
+
+        template <std::size_t N>
+        constexpr std::array<THash, N> MakeKeys(THash seed) {
+            std::array<THash, N> keys{};
+            for (std::size_t i = 0; i < N; ++i) {
+                keys[i] = SplitMix(seed);
+            }
+            return keys;
+        }
+
+        inline constexpr TPieceKeys PieceKeys = MakePieceKeys();
+        inline constexpr THash BlackToMoveKey = 0xF1E2D3C4B5A69788ULL;
+        constexpr std::array<THash, 16> MakeCastlingKeys() {
+            std::array<THash, 16> keys = MakeKeys<16>(0x436173746C696E67ULL);
+            keys[0] = 0;
+            return keys;
+        }
+
+        // Indexed by the castling rights mask; no rights hash to zero so an
+        // empty board has an empty key.
+        inline constexpr std::array<THash, 16> CastlingKeys = MakeCastlingKeys();
+        // Indexed by the file of the en-passant square.
+        inline constexpr std::array<THash, 8> EnPassantKeys = MakeKeys<8>(0x456E50617373616EULL);
+
+        constexpr THash PieceKey(const TChessPiece& piece, int square) {
+            return PieceKeys[static_cast<int>(piece.Color)][static_cast<int>(piece.Type)][square];
+        }
+    }
+}
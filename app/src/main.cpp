@@ -1,18 +1,117 @@
+#include <algorithm>
 #include <iostream>
 #include <clocale>
+#include <csignal>
 #include <cstdlib>
+#include <fstream>
+#include <string>
 
 #include "lib/chess_board.h"
 #include "lib/command.h"
+#include "lib/game_server.h"
+#include "lib/opening_book.h"
+#include "lib/search.h"
+#include "lib/stats.h"
+#include "lib/transposition_table.h"
+#include "lib/uci.h"
 
+namespace {
+    NChess::TGameServer* RunningServer = nullptr;
+
+    void StopServer(int) {
+        if (RunningServer != nullptr) {
+            RunningServer->Stop();
+        }
+    }
+}
 
 int main(int argc, char *argv[]) {
+    std::size_t hashMb = NChess::TTranspositionTable::DefaultSizeMb;
+    NChess::TSearchLimits engineLimits;
+    bool uci = false;
+    std::string script;
+    std::string bookPath;
+    std::string serverSocket;
+    std::size_t maxGames = 10000;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--hash-mb" && i + 1 < argc && std::strtoul(argv[i + 1], nullptr, 10) > 0) {
+            hashMb = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            engineLimits.Threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--uci") {
+            uci = true;
+        } else if (arg == "--script" && i + 1 < argc) {
+            script = argv[++i];
+        } else if (arg == "--book" && i + 1 < argc) {
+            bookPath = argv[++i];
+        } else if (arg == "--serve" && i + 1 < argc) {
+            serverSocket = argv[++i];
+        } else if (arg == "--max-games" && i + 1 < argc) {
+            maxGames = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "usage: app [--uci | --script FILE|- | --serve SOCKET [--max-games N]] [--hash-mb N] [--threads N] [--book FILE]" << std::endl;
+            return 1;
+        }
+    }
+
+    NChess::TOpeningBook book;
+    if (!bookPath.empty() && !book.Open(bookPath)) {
+        std::cerr << "cannot open book " << bookPath << std::endl;
+        return 1;
+    }
+    const NChess::TOpeningBook* engineBook = book.IsOpen() ? &book : nullptr;
+
+    if (!serverSocket.empty()) {
+        if (hashMb < static_cast<std::size_t>(engineLimits.Threads)) {
+            std::cerr << "--hash-mb must give every one of the " << engineLimits.Threads
+                      << " search threads at least 1 MB" << std::endl;
+            return 1;
+        }
+        NChess::TGameServer server(serverSocket, engineLimits, maxGames, hashMb);
+        RunningServer = &server;
+        std::signal(SIGINT, StopServer);
+        std::signal(SIGTERM, StopServer);
+        const bool served = server.Run();
+        RunningServer = nullptr;
+        if (!served) {
+            std::cerr << "cannot serve on " << serverSocket << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (uci) {
+        NChess::TTranspositionTable table(hashMb);
+        NChess::TBoard board;
+        NChess::TUci protocol(board, table, engineLimits, engineBook);
+        protocol.Process();
+        if (NChess::NStats::Enabled) {
+            std::cerr << NChess::NStats::Report();
+        }
+        return 0;
+    }
 
     std::locale::global(std::locale("en_US.UTF-8"));
     std::wcout.imbue(std::locale());
 
+    NChess::TTranspositionTable table(hashMb);
     NChess::TBoard board;    
-    NChess::TCommand command(board);
-    command.Process();
+    NChess::TCommand command(board, table, engineLimits, engineBook);
+    if (script == "-") {
+        command.ProcessScript(std::wcin);
+    } else if (!script.empty()) {
+        std::wifstream input(script);
+        if (!input) {
+            std::cerr << "cannot open " << script << std::endl;
+            return 1;
+        }
+        command.ProcessScript(input);
+    } else {
+        command.Process();
+    }
+    if (NChess::NStats::Enabled) {
+        std::cerr << NChess::NStats::Report();
+    }
     return 0;
 }
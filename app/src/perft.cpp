@@ -0,0 +1,91 @@
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "lib/chess_board.h"
+#include "lib/fen.h"
+#include "lib/move_generator.h"
+
+namespace {
+    struct TReferencePosition {
+        const char* Fen;
+        int Depth;
+        std::uint64_t Nodes;
+    };
+
+    // Standard perft positions with published node counts.
+    const std::array<TReferencePosition, 6> ReferencePositions {{
+        {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5, 4865609},
+        {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 4085603},
+        {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624},
+        {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333},
+        {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487},
+        {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594},
+    }};
+
+    std::uint64_t TimedPerft(NChess::TBoard& board, int depth, double& seconds) {
+        const auto start = std::chrono::steady_clock::now();
+        const std::uint64_t nodes = NChess::Perft(board, board.GetSideToMove(), depth);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        seconds = elapsed.count();
+        return nodes;
+    }
+
+    std::int64_t NodesPerSecond(std::uint64_t nodes, double seconds) {
+        return static_cast<std::int64_t>(seconds > 0 ? nodes / seconds : 0);
+    }
+
+    int RunSuite() {
+        int failures = 0;
+        for (const TReferencePosition& position : ReferencePositions) {
+            NChess::TBoard board;
+            NChess::LoadFen(board, position.Fen);
+            double seconds = 0;
+            const std::uint64_t nodes = TimedPerft(board, position.Depth, seconds);
+            const bool ok = nodes == position.Nodes;
+            failures += ok ? 0 : 1;
+            std::cout << (ok ? "ok   " : "FAIL ") << position.Fen
+                      << " depth " << position.Depth
+                      << " nodes " << nodes
+                      << " expected " << position.Nodes
+                      << " nps " << NodesPerSecond(nodes, seconds)
+                      << '\n';
+        }
+        return failures == 0 ? 0 : 2;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int maxDepth = 5;
+    std::string fen(NChess::StartFen);
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--suite") {
+            return RunSuite();
+        } else if (arg == "--fen" && i + 1 < argc) {
+            fen = argv[++i];
+        } else {
+            maxDepth = std::atoi(argv[i]);
+        }
+    }
+
+    NChess::TBoard board;
+    if (maxDepth < 1 || !NChess::LoadFen(board, fen)) {
+        std::cerr << "usage: perft [depth] [--fen FEN] | perft --suite" << std::endl;
+        return 1;
+    }
+
+    for (int depth = 1; depth <= maxDepth; ++depth) {
+        double seconds = 0;
+        const std::uint64_t nodes = TimedPerft(board, depth, seconds);
+        std::cout << "depth " << depth
+                  << " nodes " << nodes
+                  << " time " << static_cast<std::int64_t>(seconds * 1000) << " ms"
+                  << " nps " << NodesPerSecond(nodes, seconds)
+                  << '\n';
+    }
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "lib/mapped_file.h"
+#include "lib/pgn.h"
+
+int main(int argc, char *argv[]) {
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    const char* path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else if (!path && arg.rfind("--", 0) != 0) {
+            path = argv[i];
+        } else {
+            path = nullptr;
+            break;
+        }
+    }
+    if (!path || threads < 1) {
+        std::cerr << "usage: pgn_validate [--threads N] <games.pgn>" << std::endl;
+        return 1;
+    }
+
+    NChess::TMappedFile file;
+    if (!file.Open(path, true)) {
+        std::cerr << "cannot map " << path << std::endl;
+        return 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const NChess::TPgnStats stats = threads == 1
+        ? NChess::ValidatePgn(file.GetData())
+        : NChess::ValidatePgnParallel(file.GetData(), threads);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const double seconds = elapsed.count() > 0 ? elapsed.count() : 1e-9;
+
+    std::cout << "games " << stats.Games
+              << " moves " << stats.Moves
+              << " illegal_moves " << stats.IllegalMoves
+              << " errors " << stats.Errors
+              << " captured_white " << stats.CapturedWhite
+              << " captured_black " << stats.CapturedBlack << '\n'
+              << "bytes " << file.GetSize()
+              << " threads " << threads
+              << " time " << static_cast<std::int64_t>(seconds * 1000) << " ms"
+              << " games_per_second " << static_cast<std::int64_t>(stats.Games / seconds)
+              << " mb_per_second " << static_cast<std::int64_t>(file.GetSize() / seconds / (1024 * 1024))
+              << '\n';
+    return stats.IllegalMoves + stats.Errors == 0 ? 0 : 2;
+}
@@ -0,0 +1,43 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+#include "lib/chess_board.h"
+#include "lib/search.h"
+#include "lib/transposition_table.h"
+
+int main(int argc, char *argv[]) {
+    int moveTimeMs = 2000;
+    int maxThreads = 8;
+    if (argc > 1) {
+        moveTimeMs = std::atoi(argv[1]);
+    }
+    if (argc > 2) {
+        maxThreads = std::atoi(argv[2]);
+    }
+    if (moveTimeMs < 1 || maxThreads < 1) {
+        std::cerr << "usage: search_bench [movetime_ms] [max_threads]" << std::endl;
+        return 1;
+    }
+
+    NChess::TBoard board;
+    NChess::LoadStartBoard(board);
+    NChess::TTranspositionTable table;
+
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        table.Clear();
+        NChess::TSearchLimits limits;
+        limits.MoveTime = std::chrono::milliseconds(moveTimeMs);
+        limits.Threads = threads;
+        const NChess::TSearchResult result = NChess::ParallelSearch(board, table, limits);
+        const std::int64_t ms = result.Time.count();
+        std::cout << "threads " << threads
+                  << " depth " << result.Depth
+                  << " nodes " << result.Nodes
+                  << " time " << ms << " ms"
+                  << " nps " << (ms > 0 ? result.Nodes * 1000 / ms : 0)
+                  << '\n';
+    }
+    return 0;
+}
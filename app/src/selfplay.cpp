@@ -0,0 +1,177 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "lib/opening_book.h"
+#include "lib/selfplay.h"
+
+namespace {
+    // "key=value,key=value"; false on an unknown key or a malformed pair.
+    template <typename TSetter>
+    bool ParseSpec(const std::string& spec, TSetter setter) {
+        std::istringstream in(spec);
+        for (std::string pair; std::getline(in, pair, ',');) {
+            const std::size_t equals = pair.find('=');
+            if (equals == std::string::npos || !setter(pair.substr(0, equals), pair.substr(equals + 1))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool ParseEngine(const std::string& spec, NChess::TEngineConfig& config) {
+        return ParseSpec(spec, [&config](const std::string& key, const std::string& value) {
+            if (key == "name") {
+                config.Name = value;
+            } else if (key == "nodes") {
+                config.Limits.MaxNodes = std::strtoull(value.c_str(), nullptr, 10);
+            } else if (key == "depth") {
+                config.Limits.MaxDepth = std::atoi(value.c_str());
+            } else if (key == "movetime") {
+                config.Limits.MoveTime = std::chrono::milliseconds(std::atol(value.c_str()));
+            } else if (key == "hash") {
+                config.HashMb = std::strtoull(value.c_str(), nullptr, 10);
+            } else {
+                return false;
+            }
+            return true;
+        });
+    }
+
+    bool ParseSprt(const std::string& spec, NChess::TSprt& sprt) {
+        sprt.Enabled = true;
+        return ParseSpec(spec, [&sprt](const std::string& key, const std::string& value) {
+            const double number = std::atof(value.c_str());
+            if (key == "elo0") {
+                sprt.Elo0 = number;
+            } else if (key == "elo1") {
+                sprt.Elo1 = number;
+            } else if (key == "alpha") {
+                sprt.Alpha = number;
+            } else if (key == "beta") {
+                sprt.Beta = number;
+            } else {
+                return false;
+            }
+            return true;
+        });
+    }
+
+    // Engines default to a fixed node budget without a clock, which keeps
+    // the games reproducible.
+    NChess::TEngineConfig DefaultEngine(const char* name) {
+        NChess::TEngineConfig config;
+        config.Name = name;
+        config.Limits.MaxNodes = 20000;
+        config.Limits.MoveTime = std::chrono::milliseconds(0);
+        return config;
+    }
+}
+
+// Plays two engine configurations against each other and reports the score,
+// the Elo difference of the first one and, with --sprt, the test decision.
+int main(int argc, char *argv[]) {
+    NChess::TEngineConfig first = DefaultEngine("first");
+    NChess::TEngineConfig second = DefaultEngine("second");
+    NChess::TMatchOptions options;
+    const char* pgnPath = nullptr;
+    const char* bookPath = nullptr;
+    bool valid = true;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            valid = false;
+        } else if (arg == "--first") {
+            valid &= ParseEngine(argv[++i], first);
+        } else if (arg == "--second") {
+            valid &= ParseEngine(argv[++i], second);
+        } else if (arg == "--games") {
+            options.Games = std::atoi(argv[++i]);
+        } else if (arg == "--concurrency") {
+            options.Concurrency = std::atoi(argv[++i]);
+        } else if (arg == "--opening-plies") {
+            options.OpeningPlies = std::atoi(argv[++i]);
+        } else if (arg == "--max-plies") {
+            options.MaxPlies = std::atoi(argv[++i]);
+        } else if (arg == "--seed") {
+            options.Seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--sprt") {
+            valid &= ParseSprt(argv[++i], options.Sprt);
+        } else if (arg == "--book") {
+            bookPath = argv[++i];
+        } else if (arg == "--pgn") {
+            pgnPath = argv[++i];
+        } else {
+            valid = false;
+        }
+    }
+    if (!valid || options.Games < 1 || options.Concurrency < 1 || options.OpeningPlies < 0 || options.MaxPlies < 1) {
+        std::cerr << "usage: selfplay [--first SPEC] [--second SPEC] [--games N] [--concurrency N]\n"
+                  << "                [--opening-plies N] [--max-plies N] [--seed N] [--book FILE]\n"
+                  << "                [--pgn FILE] [--sprt elo0=E,elo1=E,alpha=A,beta=B]\n"
+                  << "  SPEC: name=S,nodes=N,depth=N,movetime=MS,hash=MB" << std::endl;
+        return 1;
+    }
+
+    NChess::TOpeningBook book;
+    if (bookPath != nullptr) {
+        if (!book.Open(bookPath)) {
+            std::cerr << "cannot open book " << bookPath << std::endl;
+            return 1;
+        }
+        options.Book = &book;
+    }
+    std::ofstream pgn;
+    if (pgnPath != nullptr) {
+        pgn.open(pgnPath);
+        if (!pgn) {
+            std::cerr << "cannot write " << pgnPath << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+    const NChess::TMatchResult match = NChess::PlayMatch(first, second, options,
+        [&](const NChess::TSelfPlayGame& game, const NChess::TMatchScore& score) {
+            const std::string& white = game.FirstIsWhite ? first.Name : second.Name;
+            const std::string& black = game.FirstIsWhite ? second.Name : first.Name;
+            if (pgn.is_open()) {
+                pgn << NChess::FormatPgnGame(game, white, black);
+            }
+            std::cout << "game " << game.Round + 1 << ' ' << white << " - " << black
+                      << ' ' << NChess::GameResultToString(game.Result) << " (" << game.Termination << ")"
+                      << " score +" << score.Wins << " =" << score.Draws << " -" << score.Losses;
+            if (options.Sprt.Enabled) {
+                std::cout << " llr " << std::setprecision(2) << score.GetLlr(options.Sprt.Elo0, options.Sprt.Elo1)
+                          << std::setprecision(1);
+            }
+            std::cout << '\n';
+        });
+
+    const NChess::TMatchScore& score = match.Score;
+    const double seconds = match.Seconds > 0 ? match.Seconds : 1e-9;
+    std::cout << first.Name << " vs " << second.Name
+              << " games " << score.GetGames()
+              << " +" << score.Wins << " =" << score.Draws << " -" << score.Losses
+              << " score " << score.GetScore() * 100 << "%"
+              << " elo " << score.GetElo() << " +/- " << score.GetEloMargin() << '\n';
+    if (options.Sprt.Enabled) {
+        std::cout << "sprt elo0 " << options.Sprt.Elo0 << " elo1 " << options.Sprt.Elo1
+                  << std::setprecision(2)
+                  << " llr " << score.GetLlr(options.Sprt.Elo0, options.Sprt.Elo1)
+                  << " bounds [" << options.Sprt.GetLowerBound() << ", " << options.Sprt.GetUpperBound() << "] "
+                  << (match.Sprt == NChess::ESprtResult::ACCEPT_H1 ? "H1 accepted"
+                      : match.Sprt == NChess::ESprtResult::ACCEPT_H0 ? "H0 accepted" : "inconclusive")
+                  << std::setprecision(1) << '\n';
+    }
+    std::cout << "time " << static_cast<std::int64_t>(seconds * 1000) << " ms"
+              << " games_per_hour " << static_cast<std::int64_t>(score.GetGames() * 3600 / seconds)
+              << " nodes " << match.Nodes
+              << " nps " << static_cast<std::int64_t>(match.Nodes / seconds) << '\n';
+    return 0;
+}
@@ -0,0 +1,152 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+    // Blocking line-oriented client of the game server.
+    class TClient {
+        private:
+            int Fd;
+            std::string Buffer;
+        public:
+            TClient()
+                : Fd(-1)
+            {
+            }
+            TClient(const TClient&) = delete;
+            TClient& operator=(const TClient&) = delete;
+            ~TClient() {
+                if (Fd >= 0) {
+                    ::close(Fd);
+                }
+            }
+            bool Connect(const std::string& path) {
+                sockaddr_un address{};
+                if (path.size() >= sizeof(address.sun_path)) {
+                    return false;
+                }
+                address.sun_family = AF_UNIX;
+                std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+                Fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+                return Fd >= 0 && ::connect(Fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+            }
+            bool Send(const std::string& line) {
+                const std::string data = line + '\n';
+                std::size_t sent = 0;
+                while (sent < data.size()) {
+                    const ssize_t written = ::send(Fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+                    if (written <= 0) {
+                        return false;
+                    }
+                    sent += static_cast<std::size_t>(written);
+                }
+                return true;
+            }
+            bool ReadLine(std::string& line) {
+                std::size_t end;
+                while ((end = Buffer.find('\n')) == std::string::npos) {
+                    char chunk[4096];
+                    const ssize_t got = ::read(Fd, chunk, sizeof(chunk));
+                    if (got <= 0) {
+                        return false;
+                    }
+                    Buffer.append(chunk, static_cast<std::size_t>(got));
+                }
+                line = Buffer.substr(0, end);
+                Buffer.erase(0, end + 1);
+                return true;
+            }
+            bool Command(const std::string& line, std::string& reply) {
+                return Send(line) && ReadLine(reply);
+            }
+    };
+}
+
+// Keeps N games open on one server, one connection each, and plays random
+// legal moves in round-robin until every game has made the requested plies.
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: server_load <socket> [--games N] [--plies N]" << std::endl;
+        return 1;
+    }
+    const std::string path = argv[1];
+    int gamesNumber = 1000;
+    int plies = 20;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        const std::string arg = argv[i];
+        if (arg == "--games") {
+            gamesNumber = std::atoi(argv[i + 1]);
+        } else if (arg == "--plies") {
+            plies = std::atoi(argv[i + 1]);
+        }
+    }
+
+    std::vector<TClient> clients(static_cast<std::size_t>(std::max(gamesNumber, 1)));
+    std::vector<std::string> ids(clients.size());
+    std::string reply;
+    for (std::size_t i = 0; i < clients.size(); ++i) {
+        if (!clients[i].Connect(path) || !clients[i].Command("new", reply) || reply.rfind("ok ", 0) != 0) {
+            std::cerr << "game " << i << ": cannot start (" << reply << ")" << std::endl;
+            return 1;
+        }
+        ids[i] = reply.substr(3);
+    }
+    if (clients[0].Command("stats", reply)) {
+        std::cout << reply << '\n';
+    }
+
+    std::mt19937 random(12345);
+    std::uint64_t commands = 0;
+    std::uint64_t finished = 0;
+    std::vector<bool> over(clients.size(), false);
+    const auto start = std::chrono::steady_clock::now();
+    for (int ply = 0; ply < plies; ++ply) {
+        for (std::size_t i = 0; i < clients.size(); ++i) {
+            if (over[i]) {
+                continue;
+            }
+            if (!clients[i].Command("moves " + ids[i], reply)) {
+                std::cerr << "game " << i << ": connection lost" << std::endl;
+                return 1;
+            }
+            std::istringstream moves(reply.substr(2));
+            std::vector<std::string> legal;
+            for (std::string move; moves >> move;) {
+                legal.push_back(move);
+            }
+            ++commands;
+            if (legal.empty()) {
+                over[i] = true;
+                ++finished;
+                continue;
+            }
+            const std::string& move = legal[random() % legal.size()];
+            if (!clients[i].Command("move " + ids[i] + " " + move, reply) || reply != "ok") {
+                std::cerr << "game " << i << ": move " << move << " rejected (" << reply << ")" << std::endl;
+                return 1;
+            }
+            ++commands;
+        }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const double seconds = elapsed.count() > 0 ? elapsed.count() : 1e-9;
+
+    std::cout << "games " << clients.size()
+              << " plies " << plies
+              << " finished_early " << finished
+              << " commands " << commands
+              << " time " << static_cast<std::int64_t>(seconds * 1000) << " ms"
+              << " commands_per_second " << static_cast<std::int64_t>(commands / seconds)
+              << '\n';
+    return 0;
+}